@@ -0,0 +1,1746 @@
+#include "Base16.h"
+#include "Kernels.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define NEWLINE "\r\n"
+#else
+#define NEWLINE "\n"
+#endif
+
+#define STRLINE(str) (std::string(str) + NEWLINE)
+
+namespace base16 {
+
+// Function to get a human-readable description of a status code
+const char* status_message(Status status) {
+    switch (status) {
+    case Status::Ok:
+        return "Success";
+    case Status::InvalidCharacter:
+        return "Invalid character";
+    case Status::IncompleteByte:
+        return "Incomplete hexadecimal byte";
+    case Status::OutputTooSmall:
+        return "Output buffer is too small";
+    case Status::UnknownLanguage:
+        return "Unknown language";
+    case Status::MissingDigest:
+        return "Missing digest";
+    case Status::DigestMismatch:
+        return "Digest mismatch";
+    case Status::UnsupportedCodec:
+        return "Language preset cannot hold the text of the codec";
+    }
+    return "Unknown error";
+}
+
+const size_t MAX_DUMP_OFFSET_DIGITS = 2 * sizeof(unsigned long long); // Digits of the largest offset of a dump
+
+// Function to get the number of bytes per line of a dump
+static size_t dump_columns(const Parameters& params) {
+    return std::clamp<size_t>(params.max_columns > 0 ? params.max_columns : DUMP_COLUMNS, 1, MAX_DUMP_COLUMNS);
+}
+
+// Function to get the number of bytes per digit group of a dump
+static size_t dump_group_size(const Parameters& params) {
+    size_t columns = dump_columns(params);
+    return params.group_size > 0 ? std::min<size_t>(params.group_size, columns) : columns;
+}
+
+// Function to calculate the width of the digit column of a full dump line, groups are separated by a space
+static size_t dump_digits_width(const Parameters& params) {
+    size_t columns = dump_columns(params);
+    size_t group_size = dump_group_size(params);
+    return columns * HEX_BYTE_LENGTH + (columns + group_size - 1) / group_size - 1;
+}
+
+// Function to calculate the maximum number of characters produced by encoding the given number of bytes
+size_t encoded_block_bound(size_t size, const Parameters& params) {
+    return params.codec->block_bound(size, params);
+}
+
+// Function to calculate the maximum number of hexadecimal characters produced by encoding the given number of bytes
+static size_t hex_block_bound(size_t size, const Parameters& params) {
+    if (params.dump) {
+        // Whole lines, plus an incomplete line completed by the block and the final incomplete line
+        size_t columns = dump_columns(params);
+        size_t line_length = MAX_DUMP_OFFSET_DIGITS + 2 + dump_digits_width(params) + 2 + columns + 1;
+        return (size / columns + 2) * line_length;
+    }
+
+    // Prefix, two digits, postfix, separator and a possible line break with the line texts for every byte,
+    // plus the bytes of an incomplete number carried from the previous block
+    const size_t line_texts = params.line_start.length() + params.line_end.length();
+    return (size + MAX_WORD_SIZE) * (params.prefix.length() + HEX_BYTE_LENGTH + params.postfix.length() + SEPARATOR_LENGTH + 1 + line_texts) + line_texts;
+}
+
+// Function to get the number of bytes per number of a word format
+static size_t word_size(const Parameters& params) {
+    return std::clamp<size_t>(params.word_size, 1, MAX_WORD_SIZE);
+}
+
+// Function to write cells of a compile-time layout, the fixed sizes let the copies compile to plain moves
+template <size_t CellLength, size_t DigitOffset>
+char* emit_fixed_cells(const unsigned char* data, size_t count, const Format& format, char* out) {
+    const char (*digits)[HEX_BYTE_LENGTH] = format.upper_case ? HEX_DIGITS.upper : HEX_DIGITS.lower;
+    char cell[CellLength];
+    memcpy(cell, format.inner_cell.data(), CellLength);
+
+    for (size_t i = 0; i < count; ++i) {
+        memcpy(out, cell, CellLength);
+        memcpy(out + DigitOffset, digits[data[i]], HEX_BYTE_LENGTH);
+        out += CellLength;
+    }
+    return out;
+}
+
+// Function to write cells of any layout
+char* emit_cells(const unsigned char* data, size_t count, const Format& format, char* out) {
+    const char (*digits)[HEX_BYTE_LENGTH] = format.upper_case ? HEX_DIGITS.upper : HEX_DIGITS.lower;
+    const char* cell = format.inner_cell.data();
+    const size_t cell_length = format.inner_cell.length();
+
+    for (size_t i = 0; i < count; ++i) {
+        memcpy(out, cell, cell_length);
+        memcpy(out + format.digit_offset, digits[data[i]], HEX_BYTE_LENGTH);
+        out += cell_length;
+    }
+    return out;
+}
+
+// Function to write bare digits with the vectorized kernel
+char* emit_digits(const unsigned char* data, size_t count, const Format& format, char* out) {
+    format.kernel->encode(data, count, out, format.upper_case);
+    return out + count * HEX_BYTE_LENGTH;
+}
+
+// Function to write a single cell of the given layout
+char* emit_cell(unsigned char byte, const std::string& cell, const Format& format, char* out) {
+    const char (*digits)[HEX_BYTE_LENGTH] = format.upper_case ? HEX_DIGITS.upper : HEX_DIGITS.lower;
+    memcpy(out, cell.data(), cell.length());
+    memcpy(out + format.digit_offset, digits[byte], HEX_BYTE_LENGTH);
+    return out + cell.length();
+}
+
+// Function to copy the digits of a dump line in groups separated by a space, GroupSize 0 takes the group size at run time
+template <size_t GroupSize>
+char* copy_digit_groups(const char* digits, size_t count, size_t group_size, char* out) {
+    const size_t group_length = (GroupSize > 0 ? GroupSize : group_size) * HEX_BYTE_LENGTH;
+    const size_t length = count * HEX_BYTE_LENGTH;
+    size_t i = 0;
+
+    for (; i + group_length <= length; i += group_length) {
+        memcpy(out, digits + i, group_length);
+        out[group_length] = ' ';
+        out += group_length + 1;
+    }
+    if (i < length) {
+        memcpy(out, digits + i, length - i);
+        return out + length - i;
+    }
+    return out - 1; // No space after the last group
+}
+
+// Function to write one dump line: offset, digit groups padded to the full width, two spaces and the printable characters
+static char* write_dump_line(const unsigned char* data, size_t count, unsigned long long offset, const Format& format, char* out) {
+    // The offset has at least eight lowercase digits like the offsets of xxd
+    size_t offset_digits = MIN_DUMP_OFFSET_DIGITS;
+    while (offset_digits < MAX_DUMP_OFFSET_DIGITS && (offset >> (offset_digits * 4)) != 0) {
+        offset_digits++;
+    }
+    for (size_t i = 0; i < offset_digits; ++i) {
+        out[i] = HEX_DIGITS.lower[(offset >> ((offset_digits - 1 - i) * 4)) & 0x0F][1];
+    }
+    out += offset_digits;
+    *out++ = ':';
+    *out++ = ' ';
+
+    // Digits are converted by the kernel, then copied into their groups
+    char digits[MAX_DUMP_COLUMNS * HEX_BYTE_LENGTH];
+    format.kernel->encode(data, count, digits, format.upper_case);
+    char* digits_start = out;
+    switch (format.group_size) {
+    case 1:
+        out = copy_digit_groups<1>(digits, count, 1, out);
+        break;
+    case 2:
+        out = copy_digit_groups<2>(digits, count, 2, out);
+        break;
+    case 4:
+        out = copy_digit_groups<4>(digits, count, 4, out);
+        break;
+    default:
+        out = copy_digit_groups<0>(digits, count, format.group_size, out);
+        break;
+    }
+    size_t padding = format.dump_digits_width - (out - digits_start) + 2;
+    memset(out, ' ', padding);
+    out += padding;
+
+    // Printable ASCII characters are shown as they are, all others as dots
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = data[i] >= 0x20 && data[i] < 0x7F ? static_cast<char>(data[i]) : '.';
+    }
+    out += count;
+    *out++ = '\n';
+    return out;
+}
+
+// Function to encode a block of bytes as dump lines. The bytes of an incomplete line are kept in the state
+// until the line is complete or the input ends.
+static size_t encode_dump_block(const unsigned char* data, size_t size, bool is_final, EncoderState& state, const Format& format, char* output) {
+    const size_t columns = format.max_columns;
+    char* out = output;
+    size_t i = 0;
+
+    if (!state.line.empty()) {
+        i = std::min(columns - state.line.length(), size);
+        state.line.append(reinterpret_cast<const char*>(data), i);
+        if (state.line.length() == columns || (is_final && i == size)) {
+            out = write_dump_line(reinterpret_cast<const unsigned char*>(state.line.data()), state.line.length(), format.dump_start + state.offset, format, out);
+            state.offset += state.line.length();
+            state.line.clear();
+        }
+    }
+    for (; i + columns <= size; i += columns) {
+        out = write_dump_line(data + i, columns, format.dump_start + state.offset, format, out);
+        state.offset += columns;
+    }
+    if (i < size) {
+        if (is_final) {
+            out = write_dump_line(data + i, size - i, format.dump_start + state.offset, format, out);
+            state.offset += size - i;
+        } else {
+            state.line.assign(reinterpret_cast<const char*>(data + i), size - i);
+        }
+    }
+    return out - output;
+}
+
+// Function to write one number of a word format: the cell with the digits of the bytes from the last one to the first
+static char* emit_word(const unsigned char* data, size_t count, const std::string& cell, const Format& format, char* out) {
+    const char (*digits)[HEX_BYTE_LENGTH] = format.upper_case ? HEX_DIGITS.upper : HEX_DIGITS.lower;
+    memcpy(out, cell.data(), format.digit_offset);
+    out += format.digit_offset;
+    for (size_t j = count; j-- > 0;) {
+        memcpy(out, digits[data[j]], HEX_BYTE_LENGTH);
+        out += HEX_BYTE_LENGTH;
+    }
+    const size_t rest = cell.length() - format.digit_offset - HEX_BYTE_LENGTH;
+    memcpy(out, cell.data() + format.digit_offset + HEX_BYTE_LENGTH, rest);
+    return out + rest;
+}
+
+// Function to encode a block of bytes as little-endian numbers of word_size bytes. The bytes of an incomplete
+// number are kept in the state until it is complete, the last number of the input gets only the digits of its bytes.
+static size_t encode_word_block(const unsigned char* data, size_t size, bool is_final, EncoderState& state, const Format& format, char* output) {
+    const size_t word_size = format.word_size;
+    const long long columns = format.max_columns;
+    char* out = output;
+    size_t i = 0;
+
+    // Function to write the next number with the cell of its position
+    auto put = [&](const unsigned char* word, size_t count, bool is_last) {
+        const bool is_last_column = columns > 0 && state.column_count >= columns - 1;
+        if (is_last) {
+            out = emit_word(word, count, is_last_column ? format.last_column_cell : format.last_cell, format, out);
+            state.column_count++;
+        } else if (is_last_column) {
+            out = emit_word(word, count, format.line_end_cell, format, out);
+            state.column_count = 0;
+        } else {
+            out = emit_word(word, count, format.inner_cell, format, out);
+            state.column_count++;
+        }
+    };
+
+    if (!state.line.empty()) {
+        i = std::min(word_size - state.line.length(), size);
+        state.line.append(reinterpret_cast<const char*>(data), i);
+        bool is_last = is_final && i == size;
+        if (state.line.length() == word_size || is_last) {
+            put(reinterpret_cast<const unsigned char*>(state.line.data()), state.line.length(), is_last);
+            state.line.clear();
+        }
+    }
+    for (; i + word_size <= size; i += word_size) {
+        put(data + i, word_size, is_final && i + word_size == size);
+    }
+    if (i < size) {
+        if (is_final) {
+            put(data + i, size - i, true);
+        } else {
+            state.line.assign(reinterpret_cast<const char*>(data + i), size - i);
+        }
+    }
+    return out - output;
+}
+
+// Function to compile the output layout of the parameters
+Format compile_format(const Parameters& params) {
+    Format format;
+    const std::string digits(HEX_BYTE_LENGTH, '0');
+    const std::string plain_cell = params.prefix + digits;
+    const bool wrap = params.max_columns > 0;
+
+    // Postfix and separator are only written between bytes of a wrapped line, the line texts around every line
+    format.inner_cell = plain_cell;
+    if (wrap && params.separator) {
+        format.inner_cell += params.postfix + params.separator;
+    }
+    format.line_end_cell = plain_cell + params.line_end + '\n' + params.line_start;
+    format.last_cell = (params.suppress_last_postfix ? plain_cell : format.inner_cell) + params.line_end;
+    format.last_column_cell = plain_cell + params.line_end;
+    format.line_start = params.line_start;
+    format.word_size = word_size(params);
+    format.codec = params.codec;
+    format.line_end = params.line_end;
+    format.line_break = params.line_end + '\n' + params.line_start;
+    format.digit_offset = params.prefix.length();
+    format.max_columns = wrap ? params.max_columns : 0;
+    format.upper_case = params.upper_case;
+    format.kernel = params.kernel;
+
+    if (params.dump) {
+        format.dump = true;
+        format.max_columns = dump_columns(params);
+        format.group_size = dump_group_size(params);
+        format.dump_digits_width = dump_digits_width(params);
+        format.dump_start = params.range_offset;
+    }
+
+    // Common layouts get specialized emitters: bare hex, separated bytes and prefixed "0x.., " lists
+    const size_t cell_length = format.inner_cell.length();
+    if (cell_length == 2) {
+        format.emit = emit_digits;
+    } else if (cell_length == 3 && format.digit_offset == 0) {
+        format.emit = emit_fixed_cells<3, 0>; // "00 "
+    } else if (cell_length == 3 && format.digit_offset == 1) {
+        format.emit = emit_fixed_cells<3, 1>; // "%00"
+    } else if (cell_length == 4 && format.digit_offset == 0) {
+        format.emit = emit_fixed_cells<4, 0>; // "00, "
+    } else if (cell_length == 4 && format.digit_offset == 2) {
+        format.emit = emit_fixed_cells<4, 2>; // "0x00"
+    } else if (cell_length == 6 && format.digit_offset == 2) {
+        format.emit = emit_fixed_cells<6, 2>; // "0x00, "
+    } else {
+        format.emit = emit_cells;
+    }
+    return format;
+}
+
+// Function to encode a block of bytes with a compiled layout, returns the number of characters written
+size_t encode_block(const unsigned char* data, size_t size, bool is_final, EncoderState& state, const Format& format, char* output) {
+    return format.codec->encode(data, size, is_final, state, format, output);
+}
+
+// Function to encode a block of bytes as hexadecimal cells, returns the number of characters written
+static size_t encode_hex_block(const unsigned char* data, size_t size, bool is_final, EncoderState& state, const Format& format, char* output) {
+    if (format.dump) {
+        return encode_dump_block(data, size, is_final, state, format, output);
+    }
+
+    const long long columns = format.max_columns;
+    const size_t end = is_final && size > 0 ? size - 1 : size; // The last byte of the input has its own cell
+    char* out = output;
+    size_t i = 0;
+
+    // The first line is opened before the first byte, the following ones by the line end cells
+    if (state.offset == 0 && size > 0 && state.line.empty()) {
+        memcpy(out, format.line_start.data(), format.line_start.length());
+        out += format.line_start.length();
+    }
+    state.offset += size;
+    if (format.word_size > 1) {
+        return out - output + encode_word_block(data, size, is_final, state, format, out);
+    }
+
+    while (i < end) {
+        if (columns == 0) {
+            out = format.emit(data + i, end - i, format, out);
+            state.column_count += end - i;
+            break;
+        }
+
+        // Bytes inside the line, then the last column with a line break
+        size_t count = std::min<size_t>(end - i, std::max(0LL, columns - 1 - state.column_count));
+        if (count > 0) {
+            out = format.emit(data + i, count, format, out);
+            state.column_count += count;
+            i += count;
+            continue;
+        }
+        out = emit_cell(data[i++], format.line_end_cell, format, out);
+        state.column_count = 0;
+    }
+
+    if (end < size) {
+        const std::string& cell = columns > 0 && state.column_count >= columns - 1 ? format.last_column_cell : format.last_cell;
+        out = emit_cell(data[end], cell, format, out);
+        state.column_count++;
+    }
+
+    return out - output;
+}
+
+// Function to encode a block of bytes into the output buffer, returns the number of characters written
+size_t encode_block(const unsigned char* data, size_t size, bool is_final, EncoderState& state, const Parameters& params, char* output) {
+    return encode_block(data, size, is_final, state, compile_format(params), output);
+}
+
+// Function to calculate the exact number of characters produced by encoding the given number of bytes
+size_t encoded_size(size_t input_size, const Parameters& params) {
+    return params.codec->encoded_size(input_size, params);
+}
+
+// Function to calculate the exact number of hexadecimal characters produced by encoding the given number of bytes
+static size_t hex_encoded_size(size_t input_size, const Parameters& params) {
+    if (input_size == 0) {
+        return 0;
+    }
+
+    if (params.dump) {
+        // Every line has an offset, the padded digit column, the characters and a line break
+        size_t columns = dump_columns(params);
+        size_t lines = (input_size + columns - 1) / columns;
+        size_t size = lines * (MIN_DUMP_OFFSET_DIGITS + 2 + dump_digits_width(params) + 2 + 1) + input_size;
+
+        // Offsets from 2^32 on take one more digit for every further power of 16
+        for (size_t digits = MIN_DUMP_OFFSET_DIGITS; digits < MAX_DUMP_OFFSET_DIGITS; ++digits) {
+            unsigned long long limit = 1ULL << (digits * 4);
+            size_t first_line = limit > params.range_offset ? (limit - params.range_offset + columns - 1) / columns : 0;
+            if (first_line >= lines) {
+                break;
+            }
+            size += lines - first_line;
+        }
+        return size;
+    }
+
+    // Every byte has two digits and every number a prefix, the lines are opened and closed by the line texts
+    // and the output ends with a line break
+    const size_t line_texts = params.line_start.length() + params.line_end.length();
+    const size_t numbers = (input_size + word_size(params) - 1) / word_size(params);
+    size_t size = numbers * params.prefix.length() + input_size * HEX_BYTE_LENGTH + line_texts + 1;
+    if (params.max_columns <= 0) {
+        return size; // Without wrapping postfix and separator are never written
+    }
+
+    // Postfix and separator follow every number except the last column of a line
+    size_t columns = params.max_columns;
+    size_t separated = numbers / columns * (columns - 1) + numbers % columns;
+    if (params.suppress_last_postfix && (numbers - 1) % columns < columns - 1) {
+        separated--; // The last number has no postfix
+    }
+    if (params.separator) {
+        size += separated * (params.postfix.length() + SEPARATOR_LENGTH);
+    }
+
+    // Full lines are broken except after the last number
+    size += (numbers / columns - (numbers % columns == 0 ? 1 : 0)) * (line_texts + 1);
+    return size;
+}
+
+// Function to encode a whole buffer
+Result encode(std::span<const unsigned char> input, std::span<char> output, const Parameters& params) {
+    Result result;
+    if (output.size() < encoded_size(input.size(), params)) {
+        result.status = Status::OutputTooSmall;
+        return result;
+    }
+
+    EncoderState state;
+    result.written = encode_block(input.data(), input.size(), true, state, params, output.data());
+    result.read = input.size();
+
+    // Add a newline if there are remaining columns
+    if (state.column_count != 0) {
+        output[result.written++] = '\n';
+    }
+    return result;
+}
+
+// Function to decode a block of text into the output buffer, returns the number of bytes written.
+// Decoding stops at the first invalid character, its position is stored in consumed.
+// The digits buffer must hold size + 1 + DIGITS_PADDING characters.
+// Function to check whether a character is whitespace
+static bool is_whitespace(char ch) {
+    return ch == ' ' || (ch >= '\t' && ch <= '\r');
+}
+
+// Function to remove whitespace from both ends of a string
+static std::string trim(const std::string& text) {
+    size_t begin = 0;
+    size_t end = text.length();
+    while (begin < end && is_whitespace(text[begin])) {
+        begin++;
+    }
+    while (end > begin && is_whitespace(text[end - 1])) {
+        end--;
+    }
+    return text.substr(begin, end - begin);
+}
+
+// Character standing for the size field in a compiled header or footer
+const char SIZE_WILDCARD = '\0';
+
+// Function to compile a header or footer for matching, the size field matches any number or name
+static std::string compile_text(const std::string& text) {
+    std::string compiled = trim(text);
+    const std::string field = SIZE_FIELD;
+    for (size_t position = compiled.find(field); position != std::string::npos; position = compiled.find(field, position + 1)) {
+        compiled.replace(position, field.length(), 1, SIZE_WILDCARD);
+    }
+    return compiled;
+}
+
+// Function to replace the size fields of a header or footer with the input size, or remove them when it is unknown
+std::string fill_size(const std::string& text, unsigned long long size) {
+    std::string filled = text;
+    const std::string field = SIZE_FIELD;
+    const std::string value = size == UNKNOWN_SIZE ? "" : std::to_string(size);
+    for (size_t position = filled.find(field); position != std::string::npos; position = filled.find(field, position + value.length())) {
+        filled.replace(position, field.length(), value);
+    }
+    return filled;
+}
+
+// Function to compile the input layout of the parameters
+DecodeFormat compile_decode_format(const Parameters& params) {
+    DecodeFormat format;
+    format.header = compile_text(params.header);
+    format.footer = compile_text(params.footer);
+    format.kernel = params.kernel;
+    format.codec = params.codec;
+    format.errors = params.errors;
+    format.word_size = word_size(params);
+    format.digest_marker = params.comment.empty() ? "" : params.comment + ' ';
+    format.digest = params.digest;
+
+    if (params.dump) {
+        format.dump = true;
+        format.dump_columns = dump_columns(params);
+        format.dump_digits_width = dump_digits_width(params);
+        return format;
+    }
+
+    // Characters that are neither digits nor whitespace are skipped, at most MAX_SKIP_CHARS of them. A separator
+    // that is a hexadecimal digit is skipped too and never decoded, other digits and the digits of the other
+    // codecs are never skipped, their line texts may hold letters.
+    const bool is_base16 = params.codec->encode_groups == nullptr;
+    auto add_skip_char = [&format, &params, is_base16](char ch) {
+        if (ch && !is_whitespace(ch) && (format.codec->values[static_cast<unsigned char>(ch)] == -1 || (is_base16 && ch == params.separator))
+            && format.skip_chars.find(ch) == std::string::npos && format.skip_chars.length() < MAX_SKIP_CHARS) {
+            format.skip_chars += ch;
+        }
+    };
+    add_skip_char(params.separator);
+    for (char ch : params.prefix) {
+        if (HEX_VALUES.values[static_cast<unsigned char>(ch)] >= 0) {
+            format.prefix_digits += ch;
+        } else {
+            add_skip_char(ch);
+        }
+    }
+    for (char ch : params.postfix) {
+        add_skip_char(ch);
+    }
+    for (char ch : params.line_start + params.line_end) {
+        add_skip_char(ch);
+    }
+    for (char ch : params.empty_body) {
+        if (format.codec->values[static_cast<unsigned char>(ch)] >= 0 && format.skip_chars.find(ch) == std::string::npos) {
+            format.empty_digits += ch;
+        }
+    }
+
+    // Skipped characters at the start of the footer are consumed by the body
+    size_t footer_start = 0;
+    while (footer_start < format.footer.length() && format.skip_chars.find(format.footer[footer_start]) != std::string::npos) {
+        footer_start++;
+    }
+    format.footer = trim(format.footer.substr(footer_start));
+    return format;
+}
+
+// Function to check whether a character may be part of a size field
+static bool is_size_char(char ch) {
+    return (ch >= '0' && ch <= '9') || (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') || ch == '_';
+}
+
+// Function to match the input against a header or footer, returns the number of characters matched
+static size_t match_text(const char* data, size_t size, const std::string& text, size_t& matched) {
+    size_t i = 0;
+    while (i < size && matched < text.length()) {
+        if (text[matched] == SIZE_WILDCARD) {
+            // The size field ends at the first character that cannot be part of it
+            if (is_size_char(data[i])) {
+                i++;
+            } else {
+                matched++;
+            }
+        } else if (data[i] == text[matched]) {
+            i++;
+            matched++;
+        } else {
+            break;
+        }
+    }
+    return i;
+}
+
+// Function to find the position of the digit with the given index in the input, skipped characters are no digits
+static size_t locate_digit(const char* data, size_t size, const std::string& skip_chars, size_t index) {
+    size_t position = 0;
+    for (; position < size; ++position) {
+        if (HEX_VALUES.values[static_cast<unsigned char>(data[position])] >= 0 && skip_chars.find(data[position]) == std::string::npos) {
+            if (index == 0) {
+                break;
+            }
+            index--;
+        }
+    }
+    return position;
+}
+
+// Function to put the digit pairs of little-endian numbers into the order of their bytes
+static void reverse_words(char* digits, size_t count, size_t word_size) {
+    for (size_t i = 0; i < count; ++i, digits += word_size * HEX_BYTE_LENGTH) {
+        for (size_t j = 0, k = word_size - 1; j < k; ++j, --k) {
+            std::swap_ranges(digits + j * HEX_BYTE_LENGTH, digits + (j + 1) * HEX_BYTE_LENGTH, digits + k * HEX_BYTE_LENGTH);
+        }
+    }
+}
+
+// Function to decode the body of the input until the first character that is neither a digit nor skipped.
+// Every number is written as the prefix digits followed by two digits per byte, the prefix digits are checked and dropped.
+static size_t decode_body(const char* data, size_t size, DecoderState& state, const DecodeFormat& format, std::vector<char>& digits, unsigned char* output, size_t& consumed) {
+    const size_t pending = state.pending_digits.length();
+    const size_t prefix_length = format.prefix_digits.length();
+    const size_t word_length = format.word_size * HEX_BYTE_LENGTH;
+    const size_t group_length = prefix_length + word_length;
+
+    digits.resize(pending + size + DIGITS_PADDING);
+    memcpy(digits.data(), state.pending_digits.data(), pending);
+    size_t count = pending + format.kernel->compact(data, size, format.skip_chars.c_str(), digits.data() + pending, &consumed);
+    size_t length = count / group_length;
+
+    // The digits of the prefix are checked for every group, the incomplete last one included,
+    // so the pending digits carried to the next block are always valid
+    size_t mismatch = count;
+    if (prefix_length == 1 && format.word_size == 1) {
+        // Fast path for the single '0' of 0x and 0h prefixes
+        const char prefix_digit = format.prefix_digits[0];
+        char* packed = digits.data();
+        const char* group = digits.data();
+        for (size_t i = 0; i < length; ++i, group += group_length) {
+            if (group[0] != prefix_digit) {
+                mismatch = i * group_length;
+                break;
+            }
+            packed[2 * i] = group[1];
+            packed[2 * i + 1] = group[2];
+        }
+    } else if (prefix_length > 0) {
+        for (size_t i = 0; i < length; ++i) {
+            const char* group = digits.data() + i * group_length;
+            if (memcmp(group, format.prefix_digits.data(), prefix_length) != 0) {
+                mismatch = i * group_length;
+                break;
+            }
+            memmove(digits.data() + i * word_length, group + prefix_length, word_length);
+        }
+    }
+    if (prefix_length > 0) {
+        if (mismatch == count) {
+            mismatch = length * group_length;
+        }
+        // Find the wrong prefix digit, the bytes before it are still decoded
+        while (mismatch < count && mismatch % group_length < prefix_length && digits[mismatch] == format.prefix_digits[mismatch % group_length]) {
+            mismatch++;
+        }
+        if (mismatch < count && mismatch % group_length < prefix_length) {
+            consumed = locate_digit(data, size, format.skip_chars, mismatch - pending);
+            length = mismatch / group_length;
+            count = mismatch;
+        }
+    }
+
+    if (format.word_size > 1) {
+        reverse_words(digits.data(), length, format.word_size);
+    }
+    format.kernel->decode(digits.data(), length * format.word_size, output);
+    state.pending_digits.assign(digits.data() + length * group_length, count - length * group_length);
+    return length * format.word_size;
+}
+
+// Function to decode the hexadecimal body of the input until the first character that is neither a digit nor skipped
+static size_t decode_hex_body(const char* data, size_t size, DecoderState& state, const DecodeFormat& format, std::vector<char>& digits, unsigned char* output, size_t& consumed);
+
+// Function to decode the pending digits of the last number of a word format, which only has the digits of its bytes.
+// Returns the number of bytes written.
+static size_t decode_last_word(DecoderState& state, const DecodeFormat& format, unsigned char* output) {
+    const size_t prefix_length = format.prefix_digits.length();
+    const size_t length = state.pending_digits.length();
+    if (format.word_size == 1 || length <= prefix_length || (length - prefix_length) % HEX_BYTE_LENGTH != 0) {
+        return 0;
+    }
+    const size_t count = (length - prefix_length) / HEX_BYTE_LENGTH;
+    reverse_words(state.pending_digits.data() + prefix_length, 1, count);
+    format.kernel->decode(state.pending_digits.data() + prefix_length, count, output);
+    state.pending_digits.clear();
+    return count;
+}
+
+// Function to check whether a line of a dump has the layout of a full line: hexadecimal offset, colon and space,
+// the digit column of the expected width, two spaces and one character per byte
+static bool is_full_dump_line(const char* line, const char* colon, const char* end, const DecodeFormat& format) {
+    if (colon == line || end - colon != static_cast<ptrdiff_t>(2 + format.dump_digits_width + 2 + format.dump_columns)) {
+        return false;
+    }
+    for (const char* ch = line; ch < colon; ++ch) {
+        if (HEX_VALUES.values[static_cast<unsigned char>(*ch)] < 0) {
+            return false;
+        }
+    }
+    const char* digits_end = colon + 2 + format.dump_digits_width;
+    return colon[1] == ' ' && digits_end[0] == ' ' && digits_end[1] == ' ';
+}
+
+// Function to decode the digit columns of a dump until the first invalid character. Lines of the full layout
+// are compacted and decoded as a whole, other lines are read character by character. Offsets are not checked,
+// the bytes of all lines are concatenated.
+static size_t decode_dump_body(const char* data, size_t size, DecoderState& state, const DecodeFormat& format, std::vector<char>& digits, unsigned char* output, size_t& consumed) {
+    const size_t line_digits = format.dump_columns * HEX_BYTE_LENGTH;
+    size_t written = 0;
+    size_t i = 0;
+
+    if (digits.size() < format.dump_digits_width + DIGITS_PADDING) {
+        digits.resize(format.dump_digits_width + DIGITS_PADDING);
+    }
+
+    while (i < size) {
+        if (state.dump_column == DumpColumn::Offset && state.pending_digits.empty()) {
+            const char* line = data + i;
+            const char* end = static_cast<const char*>(memchr(line, '\n', size - i));
+            const char* colon = end ? static_cast<const char*>(memchr(line, ':', end - line)) : nullptr;
+            if (colon && is_full_dump_line(line, colon, end, format)) {
+                size_t digits_consumed;
+                size_t count = format.kernel->compact(colon + 2, format.dump_digits_width, "", digits.data(), &digits_consumed);
+                if (digits_consumed == format.dump_digits_width && count == line_digits) {
+                    format.kernel->decode(digits.data(), format.dump_columns, output + written);
+                    written += format.dump_columns;
+                    i = end + 1 - data;
+                    continue;
+                }
+            }
+        }
+
+        const char ch = data[i];
+        if (state.dump_column == DumpColumn::Offset) {
+            if (ch == ':') {
+                state.dump_column = DumpColumn::Digits;
+                state.after_space = false;
+            } else if (HEX_VALUES.values[static_cast<unsigned char>(ch)] < 0 && !is_whitespace(ch)) {
+                break; // Invalid character
+            }
+        } else if (state.dump_column == DumpColumn::Digits) {
+            if (HEX_VALUES.values[static_cast<unsigned char>(ch)] >= 0) {
+                state.pending_digits += ch;
+                if (state.pending_digits.length() == HEX_BYTE_LENGTH) {
+                    format.kernel->decode(state.pending_digits.data(), 1, output + written++);
+                    state.pending_digits.clear();
+                }
+                state.after_space = false;
+            } else if (ch == ' ') {
+                // A single space separates the groups, two start the printable characters
+                if (state.after_space) {
+                    state.dump_column = DumpColumn::Text;
+                }
+                state.after_space = true;
+            } else if (ch == '\n') {
+                state.dump_column = DumpColumn::Offset;
+            } else if (!is_whitespace(ch)) {
+                break; // Invalid character
+            }
+        } else if (ch == '\n') {
+            state.dump_column = DumpColumn::Offset;
+        }
+        i++;
+    }
+
+    consumed = i;
+    return written;
+}
+
+// Function to move a position over a piece of text, the line breaks are counted by the kernel
+static void advance_position(TextPosition& position, const char* data, size_t size, const Kernel* kernel) {
+    size_t lines = kernel->count_lines(data, size);
+    if (lines == 0) {
+        position.column += size;
+    } else {
+        // Count the characters after the last line break, which is within the text since lines > 0
+        size_t column = 0;
+        while (column < size && data[size - column - 1] != '\n') {
+            column++;
+        }
+        position.line += lines;
+        position.column = column + 1;
+    }
+    position.offset += size;
+}
+
+// Function to move a position over a piece of text
+void advance_position(TextPosition& position, const char* data, size_t size) {
+    advance_position(position, data, size, select_kernel(""));
+}
+
+// Function to record an invalid character at position i of the block when the error mode tolerates it
+static void record_error(DecoderState& state, const DecodeFormat& format, const char* data, size_t i) {
+    if (state.error_count++ == 0) {
+        state.first_error = state.position;
+        advance_position(state.first_error, data, i, format.kernel);
+    }
+}
+
+// Function to add a zero digit in place of an invalid character, or the expected digit of the prefix.
+// Returns the number of bytes written when the digit completes a byte.
+static size_t replace_digit(DecoderState& state, const DecodeFormat& format, unsigned char* output) {
+    const size_t prefix_length = format.prefix_digits.length();
+    const size_t position = state.pending_digits.length();
+    state.pending_digits += position < prefix_length ? format.prefix_digits[position] : '0';
+    if (state.pending_digits.length() < prefix_length + format.word_size * HEX_BYTE_LENGTH) {
+        return 0;
+    }
+    reverse_words(state.pending_digits.data() + prefix_length, 1, format.word_size);
+    format.kernel->decode(state.pending_digits.data() + prefix_length, format.word_size, output);
+    state.pending_digits.clear();
+    return format.word_size;
+}
+
+// Function to decode a block of text into the output buffer, returns the number of bytes written
+size_t decode_block(const char* data, size_t size, DecoderState& state, const DecodeFormat& format, std::vector<char>& digits, unsigned char* output, size_t& consumed) {
+    size_t written = 0;
+    size_t i = 0;
+
+    while (i < size) {
+        if (state.phase == DecoderPhase::Header) {
+            i += match_text(data + i, size - i, format.header, state.matched);
+            if (state.matched == format.header.length()) {
+                state.phase = DecoderPhase::Body;
+            } else if (i < size) {
+                if (state.matched > 0) {
+                    if (format.errors == ErrorMode::Strict) {
+                        break; // The header does not match
+                    }
+                    record_error(state, format, data, i); // The rest is decoded as the body
+                }
+                state.phase = DecoderPhase::Body; // The input starts without a header
+            }
+        } else if (state.phase == DecoderPhase::Body) {
+            size_t body_consumed;
+            written += format.codec->decode(data + i, size - i, state, format, digits, output + written, body_consumed);
+            i += body_consumed;
+            if (i < size) {
+                if (!format.footer.empty() && data[i] == format.footer[0]) {
+                    // The body of an empty input holds no bytes
+                    if (state.is_empty && written == 0 && !format.empty_digits.empty() && state.pending_digits == format.empty_digits) {
+                        state.pending_digits.clear();
+                    }
+                    written += format.codec->decode_last(state, format, output + written);
+                    state.phase = DecoderPhase::Footer;
+                    state.matched = 0;
+                } else if (!format.digest_marker.empty() && data[i] == format.digest_marker[0]) {
+                    written += format.codec->decode_last(state, format, output + written);
+                    state.phase = DecoderPhase::Digest;
+                    state.matched = 0;
+                } else if (format.errors == ErrorMode::Strict) {
+                    break; // Invalid character
+                } else {
+                    record_error(state, format, data, i);
+                    if (format.errors == ErrorMode::Replace && (!format.dump || state.dump_column == DumpColumn::Digits)) {
+                        written += format.codec->replace(state, format, output + written);
+                    }
+                    i++;
+                }
+            }
+        } else if (state.phase == DecoderPhase::Footer) {
+            i += match_text(data + i, size - i, format.footer, state.matched);
+            if (state.matched == format.footer.length()) {
+                state.phase = DecoderPhase::Trailer;
+            } else if (i < size) {
+                if (format.errors == ErrorMode::Strict) {
+                    break; // The footer does not match
+                }
+                record_error(state, format, data, i);
+                state.phase = DecoderPhase::Body; // The text is decoded as part of the body
+            }
+        } else if (state.phase == DecoderPhase::Digest) {
+            if (state.matched < format.digest_marker.length()) {
+                i += match_text(data + i, size - i, format.digest_marker, state.matched);
+                if (state.matched < format.digest_marker.length() && i < size) {
+                    if (format.errors == ErrorMode::Strict) {
+                        break; // The comment does not match
+                    }
+                    record_error(state, format, data, i);
+                    state.phase = DecoderPhase::Body; // The text is decoded as part of the body
+                }
+                continue;
+            }
+
+            // The rest of the line holds the name and the value of the digest
+            while (i < size && data[i] != '\n' && state.digest_line.length() < MAX_DIGEST_LINE) {
+                state.digest_line += data[i++];
+            }
+            if (i < size) {
+                if (data[i] != '\n') {
+                    if (format.errors == ErrorMode::Strict) {
+                        break; // The line is too long for a digest
+                    }
+                    record_error(state, format, data, i);
+                }
+                state.phase = DecoderPhase::Trailer;
+            }
+        } else {
+            while (i < size && is_whitespace(data[i])) {
+                i++;
+            }
+            if (i < size && !format.digest_marker.empty() && data[i] == format.digest_marker[0] && state.digest_line.empty()) {
+                state.phase = DecoderPhase::Digest;
+                state.matched = 0;
+            } else if (i < size) {
+                if (format.errors == ErrorMode::Strict) {
+                    break; // Only whitespace may follow the footer
+                }
+                record_error(state, format, data, i);
+                i++;
+            }
+        }
+    }
+
+    advance_position(state.position, data, i, format.kernel);
+    state.is_empty = state.is_empty && written == 0;
+    consumed = i;
+    return written;
+}
+
+// Function to decode the incomplete last group at the end of the input
+size_t decode_last_group(DecoderState& state, const DecodeFormat& format, unsigned char* output) {
+    return state.phase == DecoderPhase::Body ? format.codec->decode_last(state, format, output) : 0;
+}
+
+// Function to check the end of the input for an incomplete byte
+Status decode_end(DecoderState& state, const DecodeFormat& format) {
+    if (state.pending_digits.empty()) {
+        return Status::Ok;
+    }
+    if (format.errors == ErrorMode::Strict) {
+        return Status::IncompleteByte;
+    }
+    record_error(state, format, nullptr, 0);
+    state.pending_digits.clear();
+    return Status::Ok;
+}
+
+// Function to get the maximum number of bytes produced by decoding the given number of characters
+size_t max_decoded_size(size_t input_size) {
+    // The pending digits of an incomplete number may complete it
+    return (input_size + HEX_BYTE_LENGTH * MAX_WORD_SIZE - 1) / HEX_BYTE_LENGTH;
+}
+
+// Function to get the maximum number of bytes produced by decoding the given number of characters with a codec
+size_t max_decoded_size(size_t input_size, const Codec* codec) {
+    return codec->max_decoded_size(input_size);
+}
+
+// Function to decode the hexadecimal body of a block, the lines of a dump or the cells of the other layouts
+static size_t decode_hex_body(const char* data, size_t size, DecoderState& state, const DecodeFormat& format, std::vector<char>& digits, unsigned char* output, size_t& consumed) {
+    if (format.dump) {
+        return decode_dump_body(data, size, state, format, digits, output, consumed);
+    }
+    return decode_body(data, size, state, format, digits, output, consumed);
+}
+
+// Codec of hexadecimal digits, converted by the kernel of the parameters
+const Codec BASE16_CODEC = {
+    "base16", 1, HEX_BYTE_LENGTH, "0123456789ABCDEF", HEX_VALUES.values, '\0', '\0',
+    encode_hex_block, decode_hex_body, decode_last_word, replace_digit, hex_encoded_size, hex_block_bound, max_decoded_size,
+    nullptr, nullptr, nullptr, nullptr,
+};
+
+// Function to decode a whole buffer block by block
+Result decode(std::span<const char> input, std::span<unsigned char> output, const Parameters& params) {
+    Result result;
+    if (output.size() < max_decoded_size(input.size(), params.codec)) {
+        result.status = Status::OutputTooSmall;
+        return result;
+    }
+
+    Decoder decoder(params);
+    result = decoder.update(input, output);
+    if (result.status == Status::Ok) {
+        Result last = decoder.finish(output.subspan(result.written));
+        result.written += last.written;
+        result.status = last.status;
+    }
+    return result;
+}
+
+// Function to decode a buffer in place block by block, every block is decoded into a scratch buffer first
+Result decode_in_place(std::span<char> buffer, const Parameters& params) {
+    Result result;
+    Decoder decoder(params);
+    const size_t block_size = std::max<size_t>(params.block_size, 1);
+    std::vector<unsigned char> bytes(std::max(max_decoded_size(std::min(buffer.size(), block_size), params.codec), MAX_GROUP_SIZE));
+
+    // Function to move decoded bytes behind the ones before them, they may only overwrite text already read
+    auto place = [&](size_t length) {
+        if (result.written + length > result.read) {
+            result.status = Status::OutputTooSmall;
+            return false;
+        }
+        memcpy(buffer.data() + result.written, bytes.data(), length);
+        result.written += length;
+        return true;
+    };
+
+    while (result.read < buffer.size()) {
+        size_t size = std::min(block_size, buffer.size() - result.read);
+        Result block = decoder.update(buffer.subspan(result.read, size), bytes);
+        result.read += block.read;
+        if (!place(block.written)) {
+            return result;
+        }
+        if (block.status != Status::Ok) {
+            result.status = block.status;
+            return result;
+        }
+    }
+
+    Result last = decoder.finish(bytes);
+    if (place(last.written)) {
+        result.status = last.status;
+    }
+    return result;
+}
+
+// Function to count the number of bytes produced by decoding the input
+Result decoded_size(std::span<const char> input, const Parameters& params) {
+    Result result;
+    Decoder decoder(params);
+    const size_t block_size = std::max<size_t>(params.block_size, 1);
+    std::vector<unsigned char> bytes(std::max(max_decoded_size(std::min(input.size(), block_size), params.codec), MAX_GROUP_SIZE));
+
+    while (result.read < input.size()) {
+        size_t size = std::min(block_size, input.size() - result.read);
+        Result block = decoder.update(input.subspan(result.read, size), bytes);
+        result.read += block.read;
+        result.written += block.written;
+        if (block.status != Status::Ok) {
+            result.status = block.status;
+            return result;
+        }
+    }
+
+    Result last = decoder.finish(bytes);
+    result.written += last.written;
+    result.status = last.status;
+    return result;
+}
+
+Encoder::Encoder(const Parameters& params)
+    : params(params), format(compile_format(params)), input_digest(params.digest) {
+}
+
+size_t Encoder::max_output_size(size_t input_size) const {
+    return encoded_block_bound(input_size + 1, params) + 1;
+}
+
+Result Encoder::update(std::span<const unsigned char> input, std::span<char> output) {
+    Result result;
+    if (input.empty()) {
+        return result;
+    }
+    if (output.size() < max_output_size(input.size())) {
+        result.status = Status::OutputTooSmall;
+        return result;
+    }
+
+    if (has_held_byte) {
+        result.written += encode_block(&held_byte, 1, false, state, format, output.data());
+    }
+    result.written += encode_block(input.data(), input.size() - 1, false, state, format, output.data() + result.written);
+    input_digest.update(input);
+    held_byte = input.back();
+    has_held_byte = true;
+    result.read = input.size();
+    return result;
+}
+
+Result Encoder::finish(std::span<char> output) {
+    Result result;
+    if (output.size() < max_output_size(0)) {
+        result.status = Status::OutputTooSmall;
+        return result;
+    }
+
+    if (has_held_byte) {
+        result.written += encode_block(&held_byte, 1, true, state, format, output.data());
+        has_held_byte = false;
+    }
+
+    // Add a newline if there are remaining columns
+    if (state.column_count != 0) {
+        output[result.written++] = '\n';
+        state.column_count = 0;
+    }
+    return result;
+}
+
+Decoder::Decoder(const Parameters& params)
+    : params(params), format(compile_decode_format(params)), output_digest(params.digest) {
+}
+
+Result Decoder::update(std::span<const char> input, std::span<unsigned char> output) {
+    Result result;
+    if (output.size() < max_decoded_size(input.size(), params.codec)) {
+        result.status = Status::OutputTooSmall;
+        return result;
+    }
+
+    // The language preset is detected once from the beginning of the input
+    if (params.auto_detect && !input.empty()) {
+        const char* lang = detect_language(input, params.codec);
+        if (lang != nullptr) {
+            set_language_settings(lang, params);
+            format = compile_decode_format(params);
+        }
+        params.auto_detect = false;
+    }
+
+    const size_t block_size = std::max<size_t>(params.block_size, 1);
+    while (result.read < input.size()) {
+        size_t size = std::min(block_size, input.size() - result.read);
+        size_t consumed;
+        size_t written = decode_block(input.data() + result.read, size, state, format, digits, output.data() + result.written, consumed);
+        output_digest.update(output.subspan(result.written, written));
+        result.written += written;
+        result.read += consumed;
+        if (consumed < size) {
+            result.status = Status::InvalidCharacter;
+            break;
+        }
+    }
+    return result;
+}
+
+Result Decoder::finish(std::span<unsigned char> output) {
+    Result result;
+    unsigned char last[MAX_GROUP_SIZE];
+    result.written = decode_last_group(state, format, last);
+    if (result.written > 0) {
+        if (result.written > output.size()) {
+            result.status = Status::OutputTooSmall;
+            return result;
+        }
+        memcpy(output.data(), last, result.written);
+        output_digest.update(output.first(result.written));
+    }
+
+    result.status = decode_end(state, format);
+    if (result.status == Status::Ok) {
+        result.status = check_digest(state, format, output_digest);
+    }
+    return result;
+}
+
+// Constants of xxHash64
+const unsigned long long XXH_PRIME1 = 11400714785074694791ULL;
+const unsigned long long XXH_PRIME2 = 14029467366897019727ULL;
+const unsigned long long XXH_PRIME3 = 1609587929392839161ULL;
+const unsigned long long XXH_PRIME4 = 9650029242287828579ULL;
+const unsigned long long XXH_PRIME5 = 2870177450012600261ULL;
+const size_t XXH_STRIPE_SIZE = 32; // Bytes consumed by the four accumulators at once
+
+// Function to rotate a 64-bit value left
+static unsigned long long rotate_left(unsigned long long value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// Function to read a little-endian 64-bit value
+static unsigned long long read64(const unsigned char* data) {
+    unsigned long long value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// Function to mix eight bytes into an xxHash64 accumulator
+static unsigned long long xxh_round(unsigned long long accumulator, unsigned long long input) {
+    accumulator += input * XXH_PRIME2;
+    return rotate_left(accumulator, 31) * XXH_PRIME1;
+}
+
+// Function to merge an accumulator into the xxHash64 result
+static unsigned long long xxh_merge(unsigned long long hash, unsigned long long accumulator) {
+    hash ^= xxh_round(0, accumulator);
+    return hash * XXH_PRIME1 + XXH_PRIME4;
+}
+
+Digest::Digest(DigestType type)
+    : digest_type(type) {
+    if (type == DigestType::Crc32c) {
+        lanes[0] = 0xFFFFFFFF;
+    } else if (type == DigestType::XxHash64) {
+        lanes[0] = XXH_PRIME1 + XXH_PRIME2;
+        lanes[1] = XXH_PRIME2;
+        lanes[2] = 0;
+        lanes[3] = 0 - XXH_PRIME1;
+    }
+}
+
+void Digest::update(std::span<const unsigned char> data) {
+    length += data.size();
+    if (digest_type == DigestType::Crc32c) {
+        lanes[0] = crc32c_update(static_cast<unsigned int>(lanes[0]), data.data(), data.size());
+        return;
+    }
+    if (digest_type != DigestType::XxHash64) {
+        return;
+    }
+
+    // Function to mix one stripe into the four accumulators
+    auto consume = [this](const unsigned char* input) {
+        for (int lane = 0; lane < 4; ++lane) {
+            lanes[lane] = xxh_round(lanes[lane], read64(input + lane * 8));
+        }
+    };
+
+    const unsigned char* input = data.data();
+    size_t size = data.size();
+    if (stripe_size > 0) {
+        size_t count = std::min(XXH_STRIPE_SIZE - stripe_size, size);
+        memcpy(stripe + stripe_size, input, count);
+        stripe_size += count;
+        input += count;
+        size -= count;
+        if (stripe_size < XXH_STRIPE_SIZE) {
+            return;
+        }
+        consume(stripe);
+        stripe_size = 0;
+    }
+    for (; size >= XXH_STRIPE_SIZE; input += XXH_STRIPE_SIZE, size -= XXH_STRIPE_SIZE) {
+        consume(input);
+    }
+    memcpy(stripe, input, size);
+    stripe_size = size;
+}
+
+unsigned long long Digest::value() const {
+    if (digest_type == DigestType::Crc32c) {
+        return lanes[0] ^ 0xFFFFFFFF;
+    }
+    if (digest_type != DigestType::XxHash64) {
+        return 0;
+    }
+
+    unsigned long long hash;
+    if (length >= XXH_STRIPE_SIZE) {
+        hash = rotate_left(lanes[0], 1) + rotate_left(lanes[1], 7) + rotate_left(lanes[2], 12) + rotate_left(lanes[3], 18);
+        for (unsigned long long lane : lanes) {
+            hash = xxh_merge(hash, lane);
+        }
+    } else {
+        hash = XXH_PRIME5; // Seed 0
+    }
+    hash += length;
+
+    // The bytes of the incomplete stripe are mixed in eight, four and one at a time
+    size_t i = 0;
+    for (; i + 8 <= stripe_size; i += 8) {
+        hash ^= xxh_round(0, read64(stripe + i));
+        hash = rotate_left(hash, 27) * XXH_PRIME1 + XXH_PRIME4;
+    }
+    if (i + 4 <= stripe_size) {
+        unsigned int word;
+        memcpy(&word, stripe + i, sizeof(word));
+        hash ^= word * XXH_PRIME1;
+        hash = rotate_left(hash, 23) * XXH_PRIME2 + XXH_PRIME3;
+        i += 4;
+    }
+    for (; i < stripe_size; ++i) {
+        hash ^= stripe[i] * XXH_PRIME5;
+        hash = rotate_left(hash, 11) * XXH_PRIME1;
+    }
+
+    // Final avalanche
+    hash ^= hash >> 33;
+    hash *= XXH_PRIME2;
+    hash ^= hash >> 29;
+    hash *= XXH_PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+// Function to get the name of a digest type used in trailers and options
+const char* digest_name(DigestType type) {
+    switch (type) {
+    case DigestType::Crc32c:
+        return "crc32c";
+    case DigestType::XxHash64:
+        return "xxh64";
+    case DigestType::None:
+        break;
+    }
+    return "none";
+}
+
+// Function to find a digest type by name
+DigestType find_digest(const std::string& name) {
+    for (DigestType type : { DigestType::Crc32c, DigestType::XxHash64 }) {
+        if (name == digest_name(type)) {
+            return type;
+        }
+    }
+    return DigestType::None;
+}
+
+// Function to get the number of digits of a digest value
+static int digest_digits(DigestType type) {
+    return type == DigestType::Crc32c ? 8 : 16;
+}
+
+// Function to format the digest trailer line: comment, name and the value in the case of the encoded digits
+std::string digest_trailer(const Parameters& params, const Digest& digest) {
+    const char* digits = params.upper_case ? "0123456789ABCDEF" : "0123456789abcdef";
+    std::string value(digest_digits(digest.type()), '0');
+    unsigned long long number = digest.value();
+    for (size_t i = value.length(); i-- > 0; number >>= 4) {
+        value[i] = digits[number & 0x0F];
+    }
+    return STRLINE(params.comment + ' ' + digest_name(digest.type()) + ": " + value);
+}
+
+// Function to split a digest trailer into its type and value, returns false if it is not one
+static bool parse_digest_line(const std::string& line, DigestType& type, unsigned long long& value) {
+    std::string text = trim(line);
+    size_t colon = text.find(": ");
+    if (colon == std::string::npos) {
+        return false;
+    }
+    type = find_digest(text.substr(0, colon));
+    std::string digits = text.substr(colon + 2);
+    if (type == DigestType::None || digits.length() != static_cast<size_t>(digest_digits(type))) {
+        return false;
+    }
+    value = 0;
+    for (char ch : digits) {
+        signed char digit = HEX_VALUES.values[static_cast<unsigned char>(ch)];
+        if (digit < 0) {
+            return false;
+        }
+        value = value << 4 | digit;
+    }
+    return true;
+}
+
+// Function to find the type of the digest trailer in the last line of the input
+DigestType detect_digest(std::span<const char> tail) {
+    size_t end = tail.size();
+    while (end > 0 && is_whitespace(tail[end - 1])) {
+        end--;
+    }
+    size_t start = end;
+    while (start > 0 && tail[start - 1] != '\n') {
+        start--;
+    }
+
+    // The line is a comment followed by a space, the name and the value
+    std::string line(tail.data() + start, end - start);
+    size_t space = line.find(' ');
+    DigestType type;
+    unsigned long long value;
+    if (space == std::string::npos || !parse_digest_line(line.substr(space + 1), type, value)) {
+        return DigestType::None;
+    }
+    return type;
+}
+
+// Function to verify the digest trailer read by the decoder against the digest of the decoded bytes
+Status check_digest(const DecoderState& state, const DecodeFormat& format, const Digest& digest) {
+    if (format.digest == DigestType::None) {
+        return Status::Ok;
+    }
+    DigestType type;
+    unsigned long long value;
+    if (!parse_digest_line(state.digest_line, type, value) || type != format.digest) {
+        return Status::MissingDigest;
+    }
+    return value == digest.value() ? Status::Ok : Status::DigestMismatch;
+}
+
+// Structure to describe a language preset holding the text of a codec in string literals, one per line
+struct TextPreset {
+    const char* lang; // Name of the language preset
+    const char* header; // First line, opening the expression joining the lines
+    const char* line_end; // Text closing the string literal of every line
+    const char* footer; // Last line, closing the expression
+};
+
+// Language presets for the codecs other than base16. The literals are concatenated by the compiler or joined
+// by a library call; the characters around them are never digits of base32 or base64.
+static const TextPreset TEXT_PRESETS[] = {
+    { "c", "const char data[] =", "\"", ";" },
+    { "cstr", "const char data[] =", "\"", ";" },
+    { "cpp", "const std::string data =", "\"", ";" },
+    { "cs", "string data = string.Concat(", "\",", "\"\");" },
+    { "vb", "Dim data As String = String.Concat(", "\",", "\"\")" },
+    { "py", "data = (", "\"", ")" },
+    { "go", "var data = strings.Join([]string{", "\",", "}, \"\")" },
+    { "rs", "let data: &str = concat!(", "\",", ");" },
+    { "swift", "let data = [", "\",", "].joined()" },
+    { "kt", "val data = listOf(", "\",", ").joinToString(\"\")" },
+    { "java", "String data = String.join(\"\",", "\",", "\"\");" },
+    { "dart", "const String data =", "\"", ";" },
+    { "js", "const data = [", "\",", "].join(\"\");" },
+    { "ts", "const data: string = [", "\",", "].join(\"\");" },
+    { "rb", "data = [", "\",", "].join" },
+    { "php", "$data = implode([", "\",", "]);" },
+    { "lua", "local data = table.concat({", "\",", "})" },
+};
+
+// Function to set the settings of a language preset holding the text of a codec other than base16 in a string.
+// File extension and comment are the ones of the preset for bytes.
+static Status set_text_language_settings(const std::string& lang, Parameters& params) {
+    Parameters byte_params;
+    byte_params.codec = select_codec("");
+    if (set_language_settings(lang, byte_params) != Status::Ok) {
+        return Status::UnknownLanguage;
+    }
+    const TextPreset* preset = std::find_if(std::begin(TEXT_PRESETS), std::end(TEXT_PRESETS), [&lang](const TextPreset& text) { return lang == text.lang; });
+    if (preset == std::end(TEXT_PRESETS) || strpbrk(params.codec->alphabet, "\"\\") != nullptr) {
+        return Status::UnsupportedCodec; // Stubs, dumps and number lists, or digits that would need escapes
+    }
+
+    params.separator = '\0';
+    params.prefix = "";
+    params.postfix = "";
+    params.suppress_last_postfix = false;
+    params.word_size = 1;
+    params.dump = false;
+    params.stub = "";
+    params.empty_body = "";
+    params.stub_relative = false;
+    params.line_start = "\"";
+    params.line_end = preset->line_end;
+    params.header = STRLINE(preset->header);
+    params.footer = STRLINE(preset->footer);
+    params.file_extension = byte_params.file_extension;
+    params.comment = byte_params.comment;
+    return Status::Ok;
+}
+
+// Function to set language-specific settings
+Status set_language_settings(const std::string& lang, Parameters& params) {
+    if (params.codec->encode_groups != nullptr) {
+        return set_text_language_settings(lang, params);
+    }
+
+    if (lang == "c") {
+        // Settings for C language
+        params.separator = ' ';
+        params.prefix = "0x";
+        params.postfix = ",";
+        params.header = STRLINE("const unsigned char data[] = {");
+        params.empty_body = STRLINE("0"); // C has no empty arrays
+        params.footer = STRLINE("};");
+        params.suppress_last_postfix = true;
+        params.file_extension = ".c";
+        params.comment = "//";
+    } else if (lang == "cstr") {
+        // Settings for C string literals, the compiler stores them without parsing a token per byte
+        params.separator = '\0'; // No separator
+        params.prefix = "\\x";
+        params.postfix = ""; // No postfix
+        params.line_start = "\"";
+        params.line_end = "\"";
+        params.header = STRLINE("const unsigned char data[{size} + 1] = \"\"");
+        params.footer = STRLINE(";");
+        params.suppress_last_postfix = false;
+        params.file_extension = ".c";
+        params.comment = "//";
+    } else if (lang == "u64") {
+        // Settings for C arrays of little-endian 64-bit numbers, one token per eight bytes
+        params.separator = ' ';
+        params.prefix = "0x";
+        params.postfix = ",";
+        params.line_end = ","; // Lines break after a postfix, the last number gets a trailing comma
+        params.word_size = 8;
+        params.header = STRLINE("#include <stddef.h>") + STRLINE("#include <stdint.h>") + STRLINE("const uint64_t data[] = {");
+        params.footer = STRLINE("};") + STRLINE("const size_t data_size = {size};");
+        params.empty_body = STRLINE("0"); // C has no empty arrays, data_size stays 0
+        params.suppress_last_postfix = true;
+        params.file_extension = ".c";
+        params.comment = "//";
+    } else if (lang == "embed") {
+        // Settings for C23 #embed of the input file, an empty file gives a single zero and data_size 0
+        params.header = STRLINE("const unsigned char data[] = {");
+        params.stub = STRLINE("#embed \"{file}\" if_empty(0)");
+        params.stub_relative = true; // Quoted names are found next to the including file first
+        params.footer = STRLINE("};") + STRLINE("const size_t data_size = {size};");
+        params.file_extension = ".c";
+        params.comment = "//";
+    } else if (lang == "incbin") {
+        // Settings for GNU assembler .incbin of the input file
+        params.header = STRLINE(".section .rodata") + STRLINE(".global data") + STRLINE(".global data_size") + STRLINE("data:");
+        params.stub = STRLINE("    .incbin \"{file}\"");
+        params.footer = STRLINE("data_size:") + STRLINE("    .quad {size}");
+        params.file_extension = ".s";
+        params.comment = "#";
+    } else if (lang == "cpp") {
+        // Settings for C++ language
+        params.separator = ' ';
+        params.prefix = "0x";
+        params.postfix = ",";
+        params.header = STRLINE("const std::vector<unsigned char> data = {");
+        params.footer = STRLINE("};");
+        params.suppress_last_postfix = true;
+        params.file_extension = ".cpp";
+        params.comment = "//";
+    } else if (lang == "cs") {
+        // Settings for C# language
+        params.separator = ' ';
+        params.prefix = "0x";
+        params.postfix = ",";
+        params.header = STRLINE("byte[] data = new byte[] {");
+        params.footer = STRLINE("};");
+        params.suppress_last_postfix = true;
+        params.file_extension = ".cs";
+        params.comment = "//";
+    } else if (lang == "vb") {
+        // Settings for Visual Basic language
+        params.separator = ' ';
+        params.prefix = "&H";
+        params.postfix = ",";
+        params.header = STRLINE("Dim data As Byte() = {");
+        params.footer = STRLINE("}");
+        params.suppress_last_postfix = true;
+        params.file_extension = ".vb";
+        params.comment = "'";
+    } else if (lang == "py") {
+        // Settings for Python language
+        params.separator = ' ';
+        params.prefix = "0x";
+        params.postfix = ",";
+        params.header = STRLINE("data = bytes([");
+        params.footer = STRLINE("])");
+        params.suppress_last_postfix = true;
+        params.file_extension = ".py";
+        params.comment = "#";
+    } else if (lang == "asm") {
+        // Settings for Assembly language
+        params.separator = ' ';
+        params.prefix = "0x";
+        params.postfix = ",";
+        params.header = STRLINE("data db ");
+        params.footer = "";
+        params.suppress_last_postfix = true;
+        params.file_extension = ".asm";
+        params.comment = ";";
+    } else if (lang == "go") {
+        // Settings for Go language
+        params.separator = ' ';
+        params.prefix = "0x";
+        params.postfix = ",";
+        params.header = STRLINE("var data = []byte{");
+        params.footer = STRLINE("}");
+        params.suppress_last_postfix = true;
+        params.file_extension = ".go";
+        params.comment = "//";
+    } else if (lang == "rs") {
+        // Settings for Rust language
+        params.separator = ' ';
+        params.prefix = "0x";
+        params.postfix = ",";
+        params.header = STRLINE("let data: [u8; {size}] = [");
+        params.footer = STRLINE("];");
+        params.suppress_last_postfix = true;
+        params.file_extension = ".rs";
+        params.comment = "//";
+    } else if (lang == "swift") {
+        // Settings for Swift language
+        params.separator = ' ';
+        params.prefix = "0x";
+        params.postfix = ",";
+        params.header = STRLINE("let data: [UInt8] = [");
+        params.footer = STRLINE("]");
+        params.suppress_last_postfix = true;
+        params.file_extension = ".swift";
+        params.comment = "//";
+    } else if (lang == "kt") {
+        // Settings for Kotlin language
+        params.separator = ' ';
+        params.prefix = "0x";
+        params.postfix = ",";
+        params.header = STRLINE("val data = byteArrayOf(");
+        params.footer = STRLINE(")");
+        params.suppress_last_postfix = true;
+        params.file_extension = ".kt";
+        params.comment = "//";
+    } else if (lang == "java") {
+        // Settings for Java language
+        params.separator = ' ';
+        params.prefix = "0x";
+        params.postfix = ",";
+        params.header = STRLINE("byte[] data = new byte[] {");
+        params.footer = STRLINE("};");
+        params.suppress_last_postfix = true;
+        params.file_extension = ".java";
+        params.comment = "//";
+    } else if (lang == "dart") {
+        // Settings for Dart language
+        params.separator = ' ';
+        params.prefix = "0x";
+        params.postfix = ",";
+        params.header = STRLINE("List<int> data = [");
+        params.footer = STRLINE("];");
+        params.suppress_last_postfix = true;
+        params.file_extension = ".dart";
+        params.comment = "//";
+    } else if (lang == "js") {
+        // Settings for JavaScript language
+        params.separator = ' ';
+        params.prefix = "0x";
+        params.postfix = ",";
+        params.header = STRLINE("const data = [");
+        params.footer = STRLINE("];");
+        params.suppress_last_postfix = true;
+        params.file_extension = ".js";
+        params.comment = "//";
+    } else if (lang == "ts") {
+        // Settings for TypeScript language
+        params.separator = ' ';
+        params.prefix = "0x";
+        params.postfix = ",";
+        params.header = STRLINE("const data: number[] = [");
+        params.footer = STRLINE("];");
+        params.suppress_last_postfix = true;
+        params.file_extension = ".ts";
+        params.comment = "//";
+    } else if (lang == "rb") {
+        // Settings for Ruby language
+        params.separator = ' ';
+        params.prefix = "0x";
+        params.postfix = ",";
+        params.header = STRLINE("data = [");
+        params.footer = STRLINE("]");
+        params.suppress_last_postfix = true;
+        params.file_extension = ".rb";
+        params.comment = "#";
+    } else if (lang == "php") {
+        // Settings for PHP language
+        params.separator = ' ';
+        params.prefix = "0x";
+        params.postfix = ",";
+        params.header = STRLINE("$data = [");
+        params.footer = STRLINE("];");
+        params.suppress_last_postfix = true;
+        params.file_extension = ".php";
+        params.comment = "//";
+    } else if (lang == "lua") {
+        // Settings for Lua language
+        params.separator = ' ';
+        params.prefix = "0x";
+        params.postfix = ",";
+        params.header = STRLINE("local data = {");
+        params.footer = STRLINE("}");
+        params.suppress_last_postfix = true;
+        params.file_extension = ".lua";
+        params.comment = "--";
+    } else if (lang == "url") {
+        // Settings for URL format
+        params.separator = '\0'; // No separator
+        params.prefix = "%"; // URL encoding prefix
+        params.postfix = ""; // No postfix
+        params.header = "http://";
+        params.footer = "";
+        params.suppress_last_postfix = false;
+        params.file_extension = "";
+        params.comment = ""; // No comment syntax
+        params.max_columns = 0;
+    } else if (lang == "bat") {
+        // Settings for BAT format
+        params.separator = ' '; // No separator
+        params.prefix = ""; // URL encoding prefix
+        params.postfix = ""; // No postfix
+        params.header = 
+            STRLINE(":BEGIN\n") +
+            STRLINE("@ECHO OFF") +
+            STRLINE("SET /P filename=\"Enter filename: \"") +
+            STRLINE("SET tmpfile=%~d0%~p0%RANDOM%.tmp") +
+            STRLINE("SET outfile=%~d0%~p0%filename%") +
+            STRLINE("ECHO tmpfile = %tmpfile%") +
+            STRLINE("ECHO outfile = %outfile%") +
+            STRLINE("FINDSTR \"^[0-9A-F][0-9A-F][^\\s]\" %0 > \"%tmpfile%\"") +
+            STRLINE("certutil -decodehex \"%tmpfile%\" \"%outfile%\"") +
+            STRLINE("TIMEOUT 3") +
+            STRLINE("DEL /F /Q \"%tmpfile%\" %0") +
+            STRLINE("EXIT") + NEWLINE;
+        params.footer = "";
+        params.suppress_last_postfix = false;
+        params.file_extension = ".bat";
+        params.comment = "REM";
+    } else if (lang == "xxd") {
+        // Settings for xxd-style dumps
+        params.separator = '\0'; // No separator
+        params.prefix = ""; // No prefix
+        params.postfix = ""; // No postfix
+        params.header = "";
+        params.footer = "";
+        params.suppress_last_postfix = false;
+        params.file_extension = ".xxd";
+        params.comment = "#";
+        params.dump = true; // Offset, grouped digits and printable characters
+    } else {
+        return Status::UnknownLanguage;
+    }
+    return Status::Ok;
+}
+
+// Names of the language presets recognized by detect_language from their header
+static const char* const LANGUAGES[] = { "c", "cstr", "u64", "cpp", "cs", "vb", "py", "asm", "go", "rs", "swift", "kt", "java", "dart", "js", "ts", "rb", "php", "lua", "url", "bat" };
+
+// Function to find the language preset whose header starts the input, the first line of the header has to match
+const char* detect_language(std::span<const char> input, const Codec* codec) {
+    for (const char* lang : LANGUAGES) {
+        Parameters params;
+        params.codec = codec;
+        if (set_language_settings(lang, params) != Status::Ok) {
+            continue;
+        }
+        std::string header = compile_text(params.header.substr(0, params.header.find('\n')));
+        size_t matched = 0;
+        match_text(input.data(), input.size(), header, matched);
+        if (!header.empty() && matched == header.length()) {
+            return lang;
+        }
+    }
+
+    // A dump starts with an offset of at least eight digits, a colon and a space
+    if (codec->encode_groups != nullptr) {
+        return nullptr;
+    }
+    size_t offset_digits = 0;
+    while (offset_digits < input.size() && HEX_VALUES.values[static_cast<unsigned char>(input[offset_digits])] >= 0) {
+        offset_digits++;
+    }
+    if (offset_digits >= MIN_DUMP_OFFSET_DIGITS && offset_digits + 1 < input.size() && input[offset_digits] == ':' && input[offset_digits + 1] == ' ') {
+        return "xxd";
+    }
+    return nullptr;
+}
+
+} // namespace base16
@@ -0,0 +1,437 @@
+#ifndef BASE16_H
+#define BASE16_H
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace base16 {
+
+// Constants
+const int HEX_BYTE_LENGTH = 2;
+const int SEPARATOR_LENGTH = 1;
+const size_t INPUT_BLOCK_SIZE = 64 * 1024; // Number of input bytes processed at once
+const size_t DIGITS_PADDING = 64; // Extra room the compaction kernels may write past the digits
+const size_t MAX_SKIP_CHARS = 8; // Maximum number of characters skipped by the compaction kernels besides whitespace
+const int DUMP_COLUMNS = 16; // Bytes per line of a dump unless set otherwise
+const int DUMP_GROUP_SIZE = 2; // Bytes per digit group of a dump unless set otherwise
+const size_t MAX_DUMP_COLUMNS = 256; // Maximum number of bytes per line of a dump
+const size_t MIN_DUMP_OFFSET_DIGITS = 8; // Minimum number of digits of the offset column of a dump
+const unsigned long long WHOLE_INPUT = ~0ULL; // Range length reaching up to the end of the input
+const unsigned long long UNKNOWN_SIZE = ~0ULL; // Input size of a stream that is not known in advance
+const size_t MAX_WORD_SIZE = 8; // Maximum number of bytes per number of a word format
+const size_t MAX_GROUP_SIZE = 8; // Maximum number of bytes or characters of a group converted at once by a codec
+const int CODEC_COLUMNS = 76; // Characters per line of the codecs other than base16 unless set otherwise
+const char SIZE_FIELD[] = "{size}"; // Field of a header or footer replaced by the number of input bytes
+const char FILE_FIELD[] = "{file}"; // Field of a stub replaced by the name of the input file
+const size_t MAX_DIGEST_LINE = 64; // Maximum number of characters of a digest trailer after its comment
+
+// Function type of a kernel converting bytes into hexadecimal digits
+typedef void (*EncodeKernel)(const unsigned char* data, size_t size, char* output, bool upper_case);
+
+// Function type of a kernel copying hexadecimal digits while skipping whitespace and the characters of skip_chars,
+// it stops at the first invalid character and returns the number of digits written
+typedef size_t (*CompactKernel)(const char* data, size_t size, const char* skip_chars, char* digits, size_t* consumed);
+
+// Function type of a kernel converting pairs of validated hexadecimal digits into bytes
+typedef void (*DecodeKernel)(const char* digits, size_t size, unsigned char* output);
+
+// Function type of a kernel counting the line breaks of a text
+typedef size_t (*LineKernel)(const char* data, size_t size);
+
+// Structure to describe a conversion kernel
+struct Kernel {
+    const char* name; // Name used with the -kernel option
+    EncodeKernel encode; // Bytes to hexadecimal digits
+    CompactKernel compact; // Input text to hexadecimal digits
+    DecodeKernel decode; // Hexadecimal digits to bytes
+    LineKernel count_lines; // Line breaks of the decoded text, for error positions
+    bool (*is_supported)(); // Check whether the current CPU can run the kernel
+};
+
+// Function to find a kernel by name, or the best one supported by the CPU if the name is empty.
+// Returns nullptr for unknown kernels and kernels the CPU cannot run.
+const Kernel* select_kernel(const std::string& name);
+
+struct Codec;
+
+// Function to find a codec by name, or base16 if the name is empty. Returns nullptr for unknown codecs.
+const Codec* select_codec(const std::string& name);
+
+// Function to get the names of all codecs separated by commas
+std::string codec_names();
+
+// Error codes returned by the library functions
+enum class Status {
+    Ok = 0,
+    InvalidCharacter, // Input contains a character that is neither a digit, whitespace nor the separator
+    IncompleteByte, // Input ends with a single digit of a byte
+    OutputTooSmall, // Output buffer cannot hold the result
+    UnknownLanguage, // Unknown language preset
+    MissingDigest, // Input has no digest trailer of the selected type
+    DigestMismatch, // Digest trailer differs from the digest of the decoded bytes
+    UnsupportedCodec, // Language preset cannot hold the text of the codec
+};
+
+// Function to get a human-readable description of a status code
+const char* status_message(Status status);
+
+// Handling of invalid characters when decoding
+enum class ErrorMode {
+    Strict, // Stop at the first invalid character
+    Skip, // Drop invalid characters and continue with the next one
+    Replace, // Decode every invalid character as a zero digit, byte offsets of the output are kept
+};
+
+// Checksums computed over the raw bytes in the same pass as the conversion
+enum class DigestType {
+    None, // No checksum
+    Crc32c, // CRC-32C (Castagnoli), with the crc32 instructions of the CPU when available
+    XxHash64, // 64-bit xxHash
+};
+
+// Structure to hold parameters for encoding/decoding
+struct Parameters {
+    bool encode_mode = true; // Flag to indicate encoding mode
+    bool upper_case = true; // Flag to indicate uppercase hexadecimal digits
+    char separator = '\0'; // Single character separator
+    std::string prefix; // Prefix for each byte
+    std::string postfix; // Postfix for each byte
+    std::string header; // Header for the entire output
+    std::string footer; // Footer for the entire output
+    bool suppress_last_postfix = false; // Flag to suppress postfix for the last byte
+    int max_columns = 0; // Maximum number of columns (bytes) per line, 0 disables wrapping
+    int max_chars = 80; // Maximum number of characters per line
+    std::string file_extension; // File extension for output
+    const Kernel* kernel = select_kernel(""); // Conversion kernel used for the hot loops
+    int threads = 1; // Number of worker threads, 1 for serial processing
+    bool auto_detect = false; // Flag to detect the language preset of decoded input from its header
+    ErrorMode errors = ErrorMode::Strict; // Handling of invalid characters when decoding
+    bool dump = false; // Flag to write and read an xxd-style dump: offset, grouped digits and printable characters
+    int group_size = DUMP_GROUP_SIZE; // Bytes per digit group of a dump, 0 for a single group
+    unsigned long long range_offset = 0; // First byte of the converted range, input byte when encoding and decoded byte when decoding; dumps show offsets from here
+    unsigned long long range_length = WHOLE_INPUT; // Number of bytes of the converted range
+    std::string line_start; // Text opening every line of bytes
+    std::string line_end; // Text closing every line of bytes before its line break
+    int word_size = 1; // Bytes per number, numbers of several bytes are little-endian and the last one is shortened
+    std::string stub; // Text written instead of the bytes, referencing the input file by its name
+    std::string empty_body; // Body written for an empty input by languages without empty arrays, decoded as no bytes
+    bool stub_relative = false; // Flag to indicate that the file name of the stub is found relative to the file holding it, otherwise it is written absolute
+    std::string stub_directory; // Directory the output of a stub is written to, empty to write the file name as given
+    DigestType digest = DigestType::None; // Checksum of the bytes written after the footer when encoding and verified when decoding
+    std::string comment = "#"; // Line comment of the output, starts the digest trailer
+    const Codec* codec = select_codec(""); // Text encoding of the bytes, max_columns counts characters for the codecs other than base16
+    size_t block_size = INPUT_BLOCK_SIZE; // Number of input bytes converted at once, the scratch buffers of the decoder grow with it
+};
+
+// Result of a conversion call
+struct Result {
+    Status status = Status::Ok; // Ok or the error that stopped the conversion
+    size_t read = 0; // Number of input bytes consumed, the position of the invalid character on error
+    size_t written = 0; // Number of output bytes written
+};
+
+// Function to set language-specific settings
+Status set_language_settings(const std::string& lang, Parameters& params);
+
+// Function to find the language preset whose header starts the input, returns nullptr if there is none.
+// The presets of codecs other than base16 have headers of their own.
+const char* detect_language(std::span<const char> input, const Codec* codec = select_codec(""));
+
+// Running checksum of the bytes converted so far
+class Digest {
+public:
+    explicit Digest(DigestType type = DigestType::None);
+
+    // Function to add the next bytes
+    void update(std::span<const unsigned char> data);
+
+    // Checksum of all bytes added so far
+    unsigned long long value() const;
+
+    // Number of bytes added so far, counted for every digest type
+    unsigned long long size() const { return length; }
+
+    DigestType type() const { return digest_type; }
+
+private:
+    DigestType digest_type;
+    unsigned long long length = 0; // Number of bytes added
+    unsigned long long lanes[4] = {}; // CRC in the first lane, or the accumulators of xxHash
+    unsigned char stripe[32] = {}; // Bytes of an incomplete xxHash stripe
+    size_t stripe_size = 0; // Number of bytes in the stripe
+};
+
+// Function to get the name of a digest type used in trailers and options
+const char* digest_name(DigestType type);
+
+// Function to find a digest type by name, returns DigestType::None for unknown names
+DigestType find_digest(const std::string& name);
+
+// Function to format the digest trailer line written after the footer: comment, name and value
+std::string digest_trailer(const Parameters& params, const Digest& digest);
+
+// Function to find the type of the digest trailer in the last line of the input, DigestType::None if there is none
+DigestType detect_digest(std::span<const char> tail);
+
+// Function to replace the size fields of a header or footer with the number of input bytes,
+// the fields are left empty for UNKNOWN_SIZE
+std::string fill_size(const std::string& text, unsigned long long size);
+
+// Exact number of characters encode() produces for the given number of input bytes
+size_t encoded_size(size_t input_size, const Parameters& params);
+
+// Maximum number of bytes decode() produces for the given number of input characters
+size_t max_decoded_size(size_t input_size);
+size_t max_decoded_size(size_t input_size, const Codec* codec);
+
+// Function to count the exact number of bytes decode() produces for the input
+Result decoded_size(std::span<const char> input, const Parameters& params);
+
+// Function to encode a whole buffer, the output must hold encoded_size(input.size()) characters.
+// The output is the encoded data including the final line break, without header and footer.
+Result encode(std::span<const unsigned char> input, std::span<char> output, const Parameters& params);
+
+// Function to decode a whole buffer, the output must hold max_decoded_size(input.size()) bytes
+Result decode(std::span<const char> input, std::span<unsigned char> output, const Parameters& params);
+
+// Function to decode a buffer in place, the bytes overwrite the text from its start and written is their number.
+// The text is decoded in blocks of params.block_size characters, no memory proportional to its size is allocated.
+// Returns Status::OutputTooSmall with the buffer partly overwritten if the bytes would overtake the text not yet
+// read, which only shortened groups such as the z of ascii85 can cause.
+Result decode_in_place(std::span<char> buffer, const Parameters& params);
+
+// Position in the input text
+struct TextPosition {
+    size_t offset = 0; // Number of characters before the position
+    size_t line = 1; // Line number, starting at 1
+    size_t column = 1; // Column number, starting at 1
+};
+
+// Function to move a position over a piece of text
+void advance_position(TextPosition& position, const char* data, size_t size);
+
+// State of the encoder carried from one input block to the next
+struct EncoderState {
+    long long column_count = 0; // Number of bytes already written to the current line
+    unsigned long long offset = 0; // Offset of the next line of a dump from the first byte encoded
+    std::string line; // Bytes of an incomplete dump line or number, written once it is complete
+};
+
+// Part of the input the decoder is in
+enum class DecoderPhase {
+    Header, // Matching the header
+    Body, // Decoding bytes
+    Footer, // Matching the footer
+    Trailer, // Only whitespace and the digest trailer may follow the footer
+    Digest, // Reading the digest trailer up to the end of its line
+};
+
+// Column of a dump line the decoder is in
+enum class DumpColumn {
+    Offset, // Offset up to the colon
+    Digits, // Groups of digits up to two spaces
+    Text, // Printable characters up to the line break
+};
+
+// State of the decoder carried from one input block to the next
+struct DecoderState {
+    DecoderPhase phase = DecoderPhase::Header; // Part of the input being decoded
+    size_t matched = 0; // Number of header or footer characters matched
+    std::string pending_digits; // Digits of an incomplete byte, including the digits of its prefix
+    TextPosition position; // Position after the decoded text, the invalid character after a strict error
+    size_t error_count = 0; // Number of invalid characters skipped or replaced
+    TextPosition first_error; // Position of the first invalid character skipped or replaced
+    DumpColumn dump_column = DumpColumn::Offset; // Column of the dump line being decoded
+    bool after_space = false; // Flag to indicate a space after the digits of a dump line
+    bool is_empty = true; // Flag to indicate that no byte has been decoded yet
+    std::string digest_line; // Name and value of the digest trailer after its comment
+
+    // Function to check whether the next block can be decoded without this state
+    bool is_byte_boundary() const { return phase == DecoderPhase::Body && pending_digits.empty() && dump_column == DumpColumn::Offset; }
+};
+
+// Input layout compiled once from the parameters. The header and footer are matched literally except
+// for their size fields, which match any number or name. In the body prefix, postfix, separator and line
+// start and end characters are skipped like whitespace and the hexadecimal characters of the prefix are
+// checked and dropped from every byte.
+struct DecodeFormat {
+    std::string header; // Header without trailing whitespace
+    std::string footer; // Footer without surrounding whitespace and the skipped characters it starts with
+    std::string skip_chars; // Characters skipped between bytes besides whitespace
+    std::string prefix_digits; // Hexadecimal characters of the prefix, written before the digits of every byte
+    std::string empty_digits; // Digits of the body of an empty input, read as no bytes when the footer follows them
+    const Kernel* kernel = nullptr; // Kernel used for compaction and decoding
+    const Codec* codec = nullptr; // Codec converting the body
+    ErrorMode errors = ErrorMode::Strict; // Handling of invalid characters
+    bool dump = false; // Flag to read an xxd-style dump, lines of the expected layout take a fast path
+    size_t dump_columns = 0; // Bytes of a full dump line
+    size_t dump_digits_width = 0; // Characters of the digit column of a full dump line
+    size_t word_size = 1; // Bytes per number, the digits of a number are in reverse byte order
+    std::string digest_marker; // Comment and space starting the digest trailer, empty without a comment
+    DigestType digest = DigestType::None; // Digest type the trailer is verified against
+};
+
+// Function to compile the input layout of the parameters
+DecodeFormat compile_decode_format(const Parameters& params);
+
+// Output layout compiled once from the parameters. Every byte is written as a copy of one
+// of the cells with its two digits patched in at digit_offset.
+struct Format {
+    std::string inner_cell; // Byte inside a line: prefix, digits, postfix and separator
+    std::string line_end_cell; // Last column of a full line: prefix, digits and line break
+    std::string last_cell; // Last byte of the input
+    std::string last_column_cell; // Last byte of the input in the last column of a line
+    size_t digit_offset = 0; // Position of the digits in every cell
+    long long max_columns = 0; // Number of bytes per line, 0 without wrapping
+    bool upper_case = true; // Flag to indicate uppercase hexadecimal digits
+    const Kernel* kernel = nullptr; // Kernel used for bare digits
+    char* (*emit)(const unsigned char* data, size_t count, const Format& format, char* out) = nullptr; // Writer of inner cells
+    bool dump = false; // Flag to write an xxd-style dump instead of the cells
+    size_t group_size = 0; // Bytes per digit group of a dump line
+    size_t dump_digits_width = 0; // Characters of the digit column of a full dump line, shorter lines are padded
+    unsigned long long dump_start = 0; // Offset shown for the first byte of a dump
+    std::string line_start; // Text opening the first line, the line end cell opens the following ones
+    size_t word_size = 1; // Bytes per number, written in reverse byte order
+    const Codec* codec = nullptr; // Codec converting the bytes
+    std::string line_end; // Text closing the last line of a codec other than base16
+    std::string line_break; // Line end, line break and line start between two lines of a codec other than base16
+};
+
+// Function to compile the output layout of the parameters
+Format compile_format(const Parameters& params);
+
+// Function to calculate the maximum number of characters produced by encoding the given number of bytes
+size_t encoded_block_bound(size_t size, const Parameters& params);
+
+// Function to encode a block of bytes into the output buffer, returns the number of characters written.
+// The final block of the input must be flagged with is_final.
+size_t encode_block(const unsigned char* data, size_t size, bool is_final, EncoderState& state, const Format& format, char* output);
+size_t encode_block(const unsigned char* data, size_t size, bool is_final, EncoderState& state, const Parameters& params, char* output);
+
+// Function to decode a block of text into the output buffer, returns the number of bytes written.
+// In strict mode decoding stops at the first invalid character, its position is stored in consumed;
+// the other error modes consume the whole block and count the invalid characters in the state.
+// The digits vector is a scratch buffer reused from one call to the next.
+size_t decode_block(const char* data, size_t size, DecoderState& state, const DecodeFormat& format, std::vector<char>& digits, unsigned char* output, size_t& consumed);
+
+// Function to decode the incomplete last group of the input at its end, returns the number of bytes written.
+// The last group of a codec may be shorter than the others, so it is only known to be complete once the input ends;
+// call it before decode_end with room for MAX_GROUP_SIZE bytes.
+size_t decode_last_group(DecoderState& state, const DecodeFormat& format, unsigned char* output);
+
+// Function to check the end of the input. An incomplete byte is an error in strict mode,
+// the other error modes drop it and count it as an invalid character.
+Status decode_end(DecoderState& state, const DecodeFormat& format);
+
+// Function to verify the digest trailer read by the decoder against the digest of the decoded bytes.
+// Without a selected digest type the trailer is not verified.
+Status check_digest(const DecoderState& state, const DecodeFormat& format, const Digest& digest);
+
+// Function type of a codec converting the bytes of a block into the body of the text, see encode_block
+typedef size_t (*BodyEncoder)(const unsigned char* data, size_t size, bool is_final, EncoderState& state, const Format& format, char* output);
+
+// Function type of a codec converting the body of a block of text into bytes, see decode_block
+typedef size_t (*BodyDecoder)(const char* data, size_t size, DecoderState& state, const DecodeFormat& format, std::vector<char>& digits, unsigned char* output, size_t& consumed);
+
+// Function type of a codec converting the digits carried in the decoder state into bytes, returns the number of bytes written
+typedef size_t (*PendingDecoder)(DecoderState& state, const DecodeFormat& format, unsigned char* output);
+
+// Function type of a kernel converting whole groups of bytes into digits
+typedef void (*GroupEncodeKernel)(const unsigned char* data, size_t groups, char* output, bool upper_case);
+
+// Function type of a kernel converting the digits of whole groups into bytes, it stops at the first group
+// holding padding or an invalid value and returns the number of groups converted
+typedef size_t (*GroupDecodeKernel)(const char* digits, size_t groups, unsigned char* output);
+
+// Function type of a kernel converting the last group of the input when it is shorter than the others.
+// Encoding returns the number of digits and padding characters written, decoding the number of bytes written,
+// or 0 when there is no group of the given number of digits.
+typedef size_t (*PartialEncodeKernel)(const unsigned char* data, size_t size, char* output, bool upper_case);
+typedef size_t (*PartialDecodeKernel)(const char* digits, size_t count, unsigned char* output);
+
+// Structure to describe a codec. The framing of the text is shared by all codecs: header and footer,
+// line texts, wrapping, digest trailers, error modes and positions, the codec converts the body.
+// Codecs converting groups of bytes share one block engine and plug in kernels for the groups;
+// base16 runs the kernel of the parameters instead.
+struct Codec {
+    const char* name; // Name used with the -codec option
+    size_t group_bytes; // Bytes converted at once, the last group of the input may be shorter
+    size_t group_chars; // Digits of a full group
+    const char* alphabet; // Digits in the order of their values
+    const signed char* values; // Value of every character: the digit value, -1 for other characters, -2 for padding, -3 for a zero group
+    char padding; // Character filling up a short last group, '\0' if the last group is only shortened
+    char zero_group; // Character standing for a whole group of zero bytes when decoding, '\0' if there is none
+    BodyEncoder encode; // Bytes of a block to text with the compiled layout
+    BodyDecoder decode; // Text of a block to bytes until the first invalid character
+    PendingDecoder decode_last; // Incomplete last group before the footer or at the end of the input
+    PendingDecoder replace; // Invalid character decoded as the digit of value zero in ErrorMode::Replace
+    size_t (*encoded_size)(size_t input_size, const Parameters& params); // Exact number of characters of encode()
+    size_t (*block_bound)(size_t size, const Parameters& params); // Maximum number of characters of encode_block()
+    size_t (*max_decoded_size)(size_t input_size); // Maximum number of bytes decoded from a block of text
+    GroupEncodeKernel encode_groups; // Whole groups to digits, nullptr for base16
+    GroupDecodeKernel decode_groups; // Digits of whole groups to bytes, nullptr for base16
+    PartialEncodeKernel encode_partial; // Short last group to digits and padding, nullptr for base16
+    PartialDecodeKernel decode_partial; // Digits of a short last group to bytes, nullptr for base16
+};
+
+// Incremental encoder converting input pieces as they arrive. The last byte seen is held back
+// until it is known whether more input follows.
+class Encoder {
+public:
+    explicit Encoder(const Parameters& params);
+
+    // Maximum number of characters written by update() for the given input size or by finish()
+    size_t max_output_size(size_t input_size) const;
+
+    // Function to encode the next piece of input
+    Result update(std::span<const unsigned char> input, std::span<char> output);
+
+    // Function to encode the held back byte and the final line break at the end of the input
+    Result finish(std::span<char> output);
+
+    // Digest of the input bytes seen so far
+    const Digest& digest() const { return input_digest; }
+
+private:
+    Parameters params;
+    Format format;
+    EncoderState state;
+    Digest input_digest;
+    bool has_held_byte = false;
+    unsigned char held_byte = 0;
+};
+
+// Incremental decoder converting input pieces as they arrive
+class Decoder {
+public:
+    explicit Decoder(const Parameters& params);
+
+    // Function to decode the next piece of input, the output must hold max_decoded_size(input.size()) bytes
+    Result update(std::span<const char> input, std::span<unsigned char> output);
+
+    // Function to decode the incomplete last group, check that the input did not end in the middle of a byte
+    // and verify the digest trailer. The output must hold MAX_GROUP_SIZE bytes.
+    Result finish(std::span<unsigned char> output = {});
+
+    // Digest of the bytes decoded so far
+    const Digest& digest() const { return output_digest; }
+
+    // Last digit of an incomplete byte, or zero
+    char pending_digit() const { return state.pending_digits.empty() ? '\0' : state.pending_digits.back(); }
+
+    // State with the position in the input and the number of invalid characters
+    const DecoderState& current_state() const { return state; }
+
+private:
+    Parameters params;
+    DecodeFormat format;
+    DecoderState state;
+    std::vector<char> digits;
+    Digest output_digest;
+};
+
+} // namespace base16
+
+#endif // BASE16_H
@@ -0,0 +1,220 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+
+#include "Base16.h"
+
+using namespace base16;
+
+// Constants
+const size_t MIN_SIZE = 1024; // Smallest input size measured by default
+const size_t MAX_SIZE = 1024 * 1024 * 1024; // Largest input size measured by default
+const size_t SIZE_STEP = 16; // Ratio between consecutive input sizes
+const size_t SAMPLE_SIZE = 16 * 1024 * 1024; // Largest distinct input, bigger inputs repeat it
+const double MIN_SECONDS = 0.25; // Minimum measuring time of one result
+
+// Structure to describe an output layout to measure
+struct Preset {
+    const char* name; // Name printed in the results
+    const char* lang; // Language preset, nullptr for custom settings
+    char separator; // Separator for custom settings
+};
+
+const Preset PRESETS[] = {
+    { "hex", nullptr, '\0' },
+    { "spaced", nullptr, ' ' },
+    { "c", "c", '\0' },
+    { "vb", "vb", '\0' },
+    { "url", "url", '\0' },
+    { "xxd", "xxd", '\0' },
+    { "cstr", "cstr", '\0' },
+    { "u64", "u64", '\0' },
+};
+
+const int WRAP_WIDTHS[] = { 0, 16, 64 };
+
+// Structure to hold the options of the benchmark
+struct Options {
+    size_t min_size = MIN_SIZE; // Smallest input size
+    size_t max_size = MAX_SIZE; // Largest input size
+    double min_seconds = MIN_SECONDS; // Minimum measuring time of one result
+    bool json = false; // Flag to print JSON lines instead of CSV
+    const Kernel* kernel = select_kernel(""); // Kernel used for the measurements
+};
+
+// Function to parse a size with an optional K, M or G suffix
+size_t parse_size(const std::string& value) {
+    size_t length;
+    unsigned long long size = std::stoull(value, &length);
+    std::string suffix = value.substr(length);
+    if (suffix == "K" || suffix == "k") {
+        size <<= 10;
+    } else if (suffix == "M" || suffix == "m") {
+        size <<= 20;
+    } else if (suffix == "G" || suffix == "g") {
+        size <<= 30;
+    } else if (!suffix.empty()) {
+        throw std::invalid_argument(value);
+    }
+    return size;
+}
+
+// Function to fill a buffer with random or all-zero data
+std::vector<unsigned char> make_data(size_t size, bool random) {
+    std::vector<unsigned char> data(size);
+    if (random) {
+        std::mt19937_64 generator(size);
+        for (size_t i = 0; i < size; i += sizeof(unsigned long long)) {
+            unsigned long long value = generator();
+            std::copy_n(reinterpret_cast<const unsigned char*>(&value), std::min(sizeof(value), size - i), data.begin() + i);
+        }
+    }
+    return data;
+}
+
+// Function to run a pass repeatedly for at least the minimum time, returns seconds per pass
+template <typename Pass>
+double measure(Pass pass, const Options& options, size_t& passes) {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+    double elapsed = 0;
+    passes = 0;
+
+    do {
+        pass();
+        passes++;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < options.min_seconds);
+
+    return elapsed / passes;
+}
+
+// Function to encode size bytes repeating the sample, the output of every block is discarded
+size_t encode_pass(const std::vector<unsigned char>& sample, size_t size, const Parameters& params, std::vector<char>& text) {
+    Encoder encoder(params);
+    size_t written = 0;
+
+    size_t offset = 0;
+    while (offset < size) {
+        size_t position = offset % sample.size();
+        size_t length = std::min({ INPUT_BLOCK_SIZE, size - offset, sample.size() - position });
+        written += encoder.update(std::span<const unsigned char>(sample.data() + position, length), text).written;
+        offset += length;
+    }
+    written += encoder.finish(text).written;
+    return written;
+}
+
+// Function to decode the encoded sample until size bytes are produced, the output of every block is discarded
+size_t decode_pass(const std::vector<char>& sample_text, size_t sample_size, size_t size, const Parameters& params, std::vector<unsigned char>& bytes) {
+    Decoder decoder(params);
+    size_t read = 0;
+
+    for (size_t produced = 0; produced < size; produced += sample_size) {
+        for (size_t offset = 0; offset < sample_text.size(); offset += INPUT_BLOCK_SIZE) {
+            std::span<const char> piece(sample_text.data() + offset, std::min(INPUT_BLOCK_SIZE, sample_text.size() - offset));
+            Result result = decoder.update(piece, bytes);
+            if (result.status != Status::Ok) {
+                throw std::runtime_error(status_message(result.status));
+            }
+            read += result.read;
+        }
+    }
+    return read;
+}
+
+// Function to print one result line
+void print_result(const Options& options, const char* operation, const Preset& preset, int wrap, bool random, size_t size, size_t text_size, size_t passes, double seconds) {
+    double mb_per_second = size / seconds / (1024 * 1024);
+    if (options.json) {
+        std::cout << "{\"operation\":\"" << operation << "\",\"preset\":\"" << preset.name << "\",\"wrap\":" << wrap
+                  << ",\"data\":\"" << (random ? "random" : "zero") << "\",\"kernel\":\"" << options.kernel->name
+                  << "\",\"size\":" << size << ",\"text_size\":" << text_size << ",\"passes\":" << passes
+                  << ",\"seconds\":" << seconds << ",\"mb_per_second\":" << mb_per_second << "}" << std::endl;
+    } else {
+        std::cout << operation << "," << preset.name << "," << wrap << "," << (random ? "random" : "zero") << ","
+                  << options.kernel->name << "," << size << "," << text_size << "," << passes << ","
+                  << seconds << "," << mb_per_second << std::endl;
+    }
+}
+
+// Function to measure one preset, wrap width and data kind across all input sizes
+void run(const Options& options, const Preset& preset, int wrap, bool random) {
+    Parameters params;
+    if (preset.lang) {
+        set_language_settings(preset.lang, params);
+    } else {
+        params.separator = preset.separator;
+    }
+    params.max_columns = wrap;
+    params.kernel = options.kernel;
+
+    std::vector<char> text(Encoder(params).max_output_size(INPUT_BLOCK_SIZE));
+    std::vector<unsigned char> bytes(max_decoded_size(INPUT_BLOCK_SIZE));
+
+    for (size_t size = options.min_size; size <= options.max_size; size *= SIZE_STEP) {
+        std::vector<unsigned char> sample = make_data(std::min(size, SAMPLE_SIZE), random);
+        size_t passes;
+        size_t text_size = 0;
+
+        double seconds = measure([&] { text_size = encode_pass(sample, size, params, text); }, options, passes);
+        print_result(options, "encode", preset, wrap, random, size, text_size, passes, seconds);
+
+        std::vector<char> sample_text(encoded_size(sample.size(), params));
+        encode(sample, sample_text, params);
+        size_t read = 0;
+        seconds = measure([&] { read = decode_pass(sample_text, sample.size(), size, params, bytes); }, options, passes);
+        print_result(options, "decode", preset, wrap, random, size, read, passes, seconds);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+
+    // Parse command-line arguments
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_next_arg = (i + 1 < argc);
+
+        try {
+            if (arg == "-min-size" && has_next_arg) {
+                options.min_size = std::max<size_t>(1, parse_size(argv[++i]));
+            } else if (arg == "-max-size" && has_next_arg) {
+                options.max_size = parse_size(argv[++i]);
+            } else if (arg == "-time" && has_next_arg) {
+                options.min_seconds = std::stod(argv[++i]);
+            } else if (arg == "-kernel" && has_next_arg) {
+                options.kernel = select_kernel(argv[++i]);
+                if (options.kernel == nullptr) {
+                    std::cerr << "Unknown kernel or not supported by this CPU: " << argv[i] << std::endl;
+                    return 1;
+                }
+            } else if (arg == "-json") {
+                options.json = true;
+            } else {
+                std::cerr << "Usage: " << argv[0] << " [-min-size size] [-max-size size] [-time seconds] [-kernel kernel] [-json]" << std::endl;
+                return arg == "-h" || arg == "-help" ? 0 : 1;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Invalid argument for " << arg << ": " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    if (!options.json) {
+        std::cout << "operation,preset,wrap,data,kernel,size,text_size,passes,seconds,mb_per_second" << std::endl;
+    }
+    for (const Preset& preset : PRESETS) {
+        for (int wrap : WRAP_WIDTHS) {
+            for (bool random : { true, false }) {
+                run(options, preset, wrap, random);
+            }
+        }
+    }
+
+    return 0;
+}
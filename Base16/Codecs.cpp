@@ -0,0 +1,565 @@
+#include "Base16.h"
+#include "Kernels.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace base16 {
+
+// Values of the characters that are not digits
+const signed char INVALID_VALUE = -1; // Character that is not part of the text of the codec
+const signed char PADDING_VALUE = -2; // Character filling up a short last group
+const signed char ZERO_GROUP_VALUE = -3; // Character standing for a whole group of zero bytes
+
+// Alphabets of the codecs, the digits in the order of their values
+const char BASE32_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+const char BASE64_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+const char BASE64URL_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+const char ASCII85_ALPHABET[] = "!\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstu";
+
+// Table of the value of every character for a codec
+struct CodecValueTable {
+    signed char values[256];
+
+    CodecValueTable(const char* alphabet, bool ignore_case, char padding, char zero_group) {
+        std::fill(std::begin(values), std::end(values), INVALID_VALUE);
+        for (int i = 0; alphabet[i] != '\0'; ++i) {
+            values[static_cast<unsigned char>(alphabet[i])] = static_cast<signed char>(i);
+            if (ignore_case) {
+                values[static_cast<unsigned char>(tolower(alphabet[i]))] = static_cast<signed char>(i);
+            }
+        }
+        if (padding != '\0') {
+            values[static_cast<unsigned char>(padding)] = PADDING_VALUE;
+        }
+        if (zero_group != '\0') {
+            values[static_cast<unsigned char>(zero_group)] = ZERO_GROUP_VALUE;
+        }
+    }
+};
+
+// Table of the two digits of every value of two digits, indexed by the bits of both digits
+struct DigitPairTable {
+    char pairs[4096][2];
+
+    DigitPairTable(const char* alphabet, int bits, bool lower_case) {
+        const int mask = (1 << bits) - 1;
+        for (int value = 0; value < (1 << (2 * bits)); ++value) {
+            pairs[value][0] = lower_case ? static_cast<char>(tolower(alphabet[value >> bits])) : alphabet[value >> bits];
+            pairs[value][1] = lower_case ? static_cast<char>(tolower(alphabet[value & mask])) : alphabet[value & mask];
+        }
+    }
+};
+
+// Base32 accepts lowercase digits, base64url also standard padding
+static const CodecValueTable BASE32_VALUES(BASE32_ALPHABET, true, '=', '\0');
+static const CodecValueTable BASE64_VALUES(BASE64_ALPHABET, false, '=', '\0');
+static const CodecValueTable BASE64URL_VALUES(BASE64URL_ALPHABET, false, '=', '\0');
+static const CodecValueTable ASCII85_VALUES(ASCII85_ALPHABET, false, '\0', 'z');
+
+static const DigitPairTable BASE32_UPPER_PAIRS(BASE32_ALPHABET, 5, false);
+static const DigitPairTable BASE32_LOWER_PAIRS(BASE32_ALPHABET, 5, true);
+static const DigitPairTable BASE64_PAIRS(BASE64_ALPHABET, 6, false);
+static const DigitPairTable BASE64URL_PAIRS(BASE64URL_ALPHABET, 6, false);
+
+// Function to check whether a character is whitespace
+static bool is_whitespace(char ch) {
+    return ch == ' ' || (ch >= '\t' && ch <= '\r');
+}
+
+// Function to copy a text to the output
+static char* copy_text(const std::string& text, char* out) {
+    memcpy(out, text.data(), text.length());
+    return out + text.length();
+}
+
+// Function to convert groups of three bytes into four base64 digits
+static void encode_base64_groups(const unsigned char* data, size_t groups, char* output, const DigitPairTable& table) {
+    for (size_t i = 0; i < groups; ++i, data += 3, output += 4) {
+        const unsigned int value = (data[0] << 16) | (data[1] << 8) | data[2];
+        memcpy(output, table.pairs[value >> 12], 2);
+        memcpy(output + 2, table.pairs[value & 0xFFF], 2);
+    }
+}
+
+// Function to convert groups of four base64 digits into three bytes
+static size_t decode_base64_groups(const char* digits, size_t groups, unsigned char* output, const signed char* values) {
+    for (size_t i = 0; i < groups; ++i, digits += 4, output += 3) {
+        const int a = values[static_cast<unsigned char>(digits[0])];
+        const int b = values[static_cast<unsigned char>(digits[1])];
+        const int c = values[static_cast<unsigned char>(digits[2])];
+        const int d = values[static_cast<unsigned char>(digits[3])];
+        if ((a | b | c | d) < 0) {
+            return i;
+        }
+        const unsigned int value = (a << 18) | (b << 12) | (c << 6) | d;
+        output[0] = static_cast<unsigned char>(value >> 16);
+        output[1] = static_cast<unsigned char>(value >> 8);
+        output[2] = static_cast<unsigned char>(value);
+    }
+    return groups;
+}
+
+// Function to convert groups of five bytes into eight base32 digits
+static void encode_base32_groups(const unsigned char* data, size_t groups, char* output, bool upper_case) {
+    const DigitPairTable& table = upper_case ? BASE32_UPPER_PAIRS : BASE32_LOWER_PAIRS;
+    for (size_t i = 0; i < groups; ++i, data += 5, output += 8) {
+        const unsigned long long value = (static_cast<unsigned long long>(data[0]) << 32) | (static_cast<unsigned long long>(data[1]) << 24)
+            | (data[2] << 16) | (data[3] << 8) | data[4];
+        memcpy(output, table.pairs[(value >> 30) & 0x3FF], 2);
+        memcpy(output + 2, table.pairs[(value >> 20) & 0x3FF], 2);
+        memcpy(output + 4, table.pairs[(value >> 10) & 0x3FF], 2);
+        memcpy(output + 6, table.pairs[value & 0x3FF], 2);
+    }
+}
+
+// Function to convert groups of eight base32 digits into five bytes
+static size_t decode_base32_groups(const char* digits, size_t groups, unsigned char* output) {
+    for (size_t i = 0; i < groups; ++i, digits += 8, output += 5) {
+        unsigned long long value = 0;
+        int invalid = 0;
+        for (int j = 0; j < 8; ++j) {
+            const int digit = BASE32_VALUES.values[static_cast<unsigned char>(digits[j])];
+            invalid |= digit;
+            value = (value << 5) | (digit & 0x1F);
+        }
+        if (invalid < 0) {
+            return i;
+        }
+        for (int j = 0; j < 5; ++j) {
+            output[j] = static_cast<unsigned char>(value >> (32 - 8 * j));
+        }
+    }
+    return groups;
+}
+
+// Function to convert groups of four bytes into five Ascii85 digits, groups of zero bytes are written out as well
+static void encode_ascii85_groups(const unsigned char* data, size_t groups, char* output, bool) {
+    for (size_t i = 0; i < groups; ++i, data += 4, output += 5) {
+        unsigned int value = (static_cast<unsigned int>(data[0]) << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+        for (int j = 4; j >= 0; --j) {
+            output[j] = static_cast<char>('!' + value % 85);
+            value /= 85;
+        }
+    }
+}
+
+// Function to convert groups of five Ascii85 digits into four bytes, a group above 2^32 - 1 is invalid
+static size_t decode_ascii85_groups(const char* digits, size_t groups, unsigned char* output) {
+    for (size_t i = 0; i < groups; ++i, digits += 5, output += 4) {
+        unsigned long long value = 0;
+        int invalid = 0;
+        for (int j = 0; j < 5; ++j) {
+            const int digit = ASCII85_VALUES.values[static_cast<unsigned char>(digits[j])];
+            invalid |= digit;
+            value = value * 85 + (digit & 0x7F);
+        }
+        if (invalid < 0 || value > 0xFFFFFFFFULL) {
+            return i;
+        }
+        output[0] = static_cast<unsigned char>(value >> 24);
+        output[1] = static_cast<unsigned char>(value >> 16);
+        output[2] = static_cast<unsigned char>(value >> 8);
+        output[3] = static_cast<unsigned char>(value);
+    }
+    return groups;
+}
+
+// Function to convert the bytes of a short last group into digits of the given number of bits, padded to a whole group
+// when the codec has a padding character. Returns the number of characters written.
+static size_t encode_bits_partial(const unsigned char* data, size_t size, char* output, int bits, const char* alphabet, bool lower_case, char padding, size_t group_chars) {
+    const size_t count = (size * 8 + bits - 1) / bits;
+    unsigned long long value = 0;
+    for (size_t i = 0; i < size; ++i) {
+        value = (value << 8) | data[i];
+    }
+    value <<= count * bits - size * 8;
+    for (size_t i = 0; i < count; ++i) {
+        const char digit = alphabet[(value >> ((count - 1 - i) * bits)) & ((1 << bits) - 1)];
+        output[i] = lower_case ? static_cast<char>(tolower(digit)) : digit;
+    }
+    if (padding == '\0') {
+        return count;
+    }
+    memset(output + count, padding, group_chars - count);
+    return group_chars;
+}
+
+// Function to convert the digits of a short last group of the given number of bits into bytes. Returns 0 if the
+// number of digits cannot end a group: a digit that does not complete another byte would only hold padding bits.
+static size_t decode_bits_partial(const char* digits, size_t count, unsigned char* output, int bits, const signed char* values, size_t group_chars) {
+    const size_t size = count * bits / 8;
+    if (count == 0 || count >= group_chars || size == (count - 1) * bits / 8) {
+        return 0;
+    }
+    unsigned long long value = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const int digit = values[static_cast<unsigned char>(digits[i])];
+        if (digit < 0) {
+            return 0;
+        }
+        value = (value << bits) | digit;
+    }
+    value >>= count * bits - size * 8;
+    for (size_t i = 0; i < size; ++i) {
+        output[i] = static_cast<unsigned char>(value >> ((size - 1 - i) * 8));
+    }
+    return size;
+}
+
+static void encode_base64(const unsigned char* data, size_t groups, char* output, bool) {
+    encode_base64_groups(data, groups, output, BASE64_PAIRS);
+}
+
+static size_t decode_base64(const char* digits, size_t groups, unsigned char* output) {
+    return decode_base64_groups(digits, groups, output, BASE64_VALUES.values);
+}
+
+static size_t encode_base64_partial(const unsigned char* data, size_t size, char* output, bool) {
+    return encode_bits_partial(data, size, output, 6, BASE64_ALPHABET, false, '=', 4);
+}
+
+static size_t decode_base64_partial(const char* digits, size_t count, unsigned char* output) {
+    return decode_bits_partial(digits, count, output, 6, BASE64_VALUES.values, 4);
+}
+
+static void encode_base64url(const unsigned char* data, size_t groups, char* output, bool) {
+    encode_base64_groups(data, groups, output, BASE64URL_PAIRS);
+}
+
+static size_t decode_base64url(const char* digits, size_t groups, unsigned char* output) {
+    return decode_base64_groups(digits, groups, output, BASE64URL_VALUES.values);
+}
+
+// The last group of base64url is written without padding, as in URLs and tokens
+static size_t encode_base64url_partial(const unsigned char* data, size_t size, char* output, bool) {
+    return encode_bits_partial(data, size, output, 6, BASE64URL_ALPHABET, false, '\0', 4);
+}
+
+static size_t decode_base64url_partial(const char* digits, size_t count, unsigned char* output) {
+    return decode_bits_partial(digits, count, output, 6, BASE64URL_VALUES.values, 4);
+}
+
+static size_t encode_base32_partial(const unsigned char* data, size_t size, char* output, bool upper_case) {
+    return encode_bits_partial(data, size, output, 5, BASE32_ALPHABET, !upper_case, '=', 8);
+}
+
+static size_t decode_base32_partial(const char* digits, size_t count, unsigned char* output) {
+    return decode_bits_partial(digits, count, output, 5, BASE32_VALUES.values, 8);
+}
+
+// Function to convert the bytes of a short last Ascii85 group: the group is filled up with zero bytes
+// and only one digit more than the number of bytes is written
+static size_t encode_ascii85_partial(const unsigned char* data, size_t size, char* output, bool upper_case) {
+    unsigned char group[4] = {};
+    char digits[5];
+    memcpy(group, data, size);
+    encode_ascii85_groups(group, 1, digits, upper_case);
+    memcpy(output, digits, size + 1);
+    return size + 1;
+}
+
+// Function to convert the digits of a short last Ascii85 group: the group is filled up with the highest digit
+// and one byte less than the number of digits is kept
+static size_t decode_ascii85_partial(const char* digits, size_t count, unsigned char* output) {
+    if (count < 2 || count >= 5) {
+        return 0;
+    }
+    char group[5];
+    unsigned char bytes[4];
+    memcpy(group, digits, count);
+    memset(group + count, 'u', 5 - count);
+    if (decode_ascii85_groups(group, 1, bytes) == 0) {
+        return 0;
+    }
+    memcpy(output, bytes, count - 1);
+    return count - 1;
+}
+
+// Function to write the digits of a group, the line is broken before a digit that does not fit on it
+static char* put_digits(const char* digits, size_t count, EncoderState& state, const Format& format, char* out) {
+    for (size_t i = 0; i < count; ++i) {
+        if (format.max_columns > 0 && state.column_count == format.max_columns) {
+            out = copy_text(format.line_break, out);
+            state.column_count = 0;
+        }
+        *out++ = digits[i];
+        state.column_count++;
+    }
+    return out;
+}
+
+// Function to encode a block of bytes in groups, returns the number of characters written. The bytes of an
+// incomplete group are kept in the state until it is complete or the input ends. Lines are wrapped after
+// max_columns characters; whole groups that fit on the line are converted by the kernel straight into the output.
+static size_t encode_group_block(const unsigned char* data, size_t size, bool is_final, EncoderState& state, const Format& format, char* output) {
+    const Codec& codec = *format.codec;
+    const long long columns = format.max_columns;
+    char group[MAX_GROUP_SIZE];
+    char* out = output;
+    size_t i = 0;
+
+    // The first line is opened before the first byte, the following ones by the line breaks
+    if (state.offset == 0 && size > 0 && state.line.empty()) {
+        out = copy_text(format.line_start, out);
+    }
+    state.offset += size;
+
+    if (!state.line.empty()) {
+        i = std::min(codec.group_bytes - state.line.length(), size);
+        state.line.append(reinterpret_cast<const char*>(data), i);
+        if (state.line.length() == codec.group_bytes) {
+            codec.encode_groups(reinterpret_cast<const unsigned char*>(state.line.data()), 1, group, format.upper_case);
+            out = put_digits(group, codec.group_chars, state, format, out);
+            state.line.clear();
+        }
+    }
+
+    while (size - i >= codec.group_bytes) {
+        const size_t groups = (size - i) / codec.group_bytes;
+        if (columns == 0) {
+            codec.encode_groups(data + i, groups, out, format.upper_case);
+            out += groups * codec.group_chars;
+            state.column_count += groups * codec.group_chars;
+            i += groups * codec.group_bytes;
+            break;
+        }
+        if (state.column_count == columns) {
+            out = copy_text(format.line_break, out);
+            state.column_count = 0;
+        }
+
+        // Groups that fit on the line, or a group broken over two lines
+        const size_t count = std::min<size_t>(groups, (columns - state.column_count) / codec.group_chars);
+        if (count > 0) {
+            codec.encode_groups(data + i, count, out, format.upper_case);
+            out += count * codec.group_chars;
+            state.column_count += count * codec.group_chars;
+            i += count * codec.group_bytes;
+        } else {
+            codec.encode_groups(data + i, 1, group, format.upper_case);
+            out = put_digits(group, codec.group_chars, state, format, out);
+            i += codec.group_bytes;
+        }
+    }
+
+    if (i < size) {
+        state.line.assign(reinterpret_cast<const char*>(data + i), size - i);
+    }
+    if (is_final) {
+        if (!state.line.empty()) {
+            size_t count = codec.encode_partial(reinterpret_cast<const unsigned char*>(state.line.data()), state.line.length(), group, format.upper_case);
+            out = put_digits(group, count, state, format, out);
+            state.line.clear();
+        }
+        if (state.offset > 0) {
+            out = copy_text(format.line_end, out);
+        }
+    } else if (columns > 0 && state.column_count == columns) {
+        // More bytes follow, so the next block starts on a new line
+        out = copy_text(format.line_break, out);
+        state.column_count = 0;
+    }
+    return out - output;
+}
+
+// Function to calculate the exact number of characters produced by encoding the given number of bytes in groups
+static size_t group_encoded_size(size_t input_size, const Parameters& params) {
+    if (input_size == 0) {
+        return 0;
+    }
+
+    // Whole groups, the digits of the short last group, the line texts and the final line break
+    const Codec& codec = *params.codec;
+    const unsigned char zeros[MAX_GROUP_SIZE] = {};
+    char digits[MAX_GROUP_SIZE];
+    const size_t rest = input_size % codec.group_bytes;
+    const size_t chars = input_size / codec.group_bytes * codec.group_chars + (rest > 0 ? codec.encode_partial(zeros, rest, digits, params.upper_case) : 0);
+    const size_t line_texts = params.line_start.length() + params.line_end.length();
+    size_t size = chars + line_texts + 1;
+    if (params.max_columns > 0) {
+        size += (chars - 1) / params.max_columns * (line_texts + 1);
+    }
+    return size;
+}
+
+// Function to calculate the maximum number of characters produced by encoding a block of bytes in groups
+static size_t group_block_bound(size_t size, const Parameters& params) {
+    // The groups of the block, a group completed from the previous block and the short last group
+    const Codec& codec = *params.codec;
+    const size_t chars = (size / codec.group_bytes + 2) * codec.group_chars;
+    const size_t lines = params.max_columns > 0 ? chars / params.max_columns + 2 : 0;
+    return chars + (lines + 1) * (params.line_start.length() + params.line_end.length() + 1);
+}
+
+// Function to calculate the maximum number of bytes produced by decoding the given number of characters in groups.
+// The digits of an incomplete group may be carried from the previous block and a zero group character stands for a whole group.
+template <size_t GroupBytes, size_t GroupChars, bool HasZeroGroup>
+size_t max_group_decoded_size(size_t input_size) {
+    const size_t digits = HasZeroGroup ? input_size * GroupChars : input_size;
+    return ((digits + GroupChars - 1) / GroupChars + 1) * GroupBytes;
+}
+
+// Function to copy the digits and padding of a codec while skipping whitespace and the skipped characters,
+// it stops at the first invalid character and returns the number of digits written. A zero group character
+// is written as a group of zero digits, it is invalid inside a group.
+static size_t compact_group_digits(const char* data, size_t size, const DecodeFormat& format, size_t pending, char* digits, size_t& consumed) {
+    const Codec& codec = *format.codec;
+    size_t count = 0;
+    size_t i = 0;
+    for (; i < size; ++i) {
+        const char ch = data[i];
+        const signed char value = codec.values[static_cast<unsigned char>(ch)];
+        if (value >= 0 || value == PADDING_VALUE) {
+            digits[count++] = ch;
+        } else if (value == ZERO_GROUP_VALUE && (pending + count) % codec.group_chars == 0) {
+            memset(digits + count, codec.alphabet[0], codec.group_chars);
+            count += codec.group_chars;
+        } else if (!is_whitespace(ch) && format.skip_chars.find(ch) == std::string::npos) {
+            break;
+        }
+    }
+    consumed = i;
+    return count;
+}
+
+// Function to find the position in the input of the digit with the given index after compaction
+static size_t locate_group_digit(const char* data, size_t size, const Codec& codec, size_t index) {
+    size_t count = 0;
+    for (size_t position = 0; position < size; ++position) {
+        const signed char value = codec.values[static_cast<unsigned char>(data[position])];
+        if (value != INVALID_VALUE) {
+            if (count >= index) {
+                return position;
+            }
+            count += value == ZERO_GROUP_VALUE ? codec.group_chars : 1;
+        }
+    }
+    return size;
+}
+
+// Function to decode the digits of a short last group followed by nothing but padding, returns the number
+// of bytes written or 0 if the digits cannot end a group
+static size_t decode_short_group(const char* digits, size_t count, const Codec& codec, unsigned char* output) {
+    size_t length = 0;
+    while (length < count && codec.values[static_cast<unsigned char>(digits[length])] != PADDING_VALUE) {
+        length++;
+    }
+    for (size_t i = length; i < count; ++i) {
+        if (codec.values[static_cast<unsigned char>(digits[i])] != PADDING_VALUE) {
+            return 0;
+        }
+    }
+    return codec.decode_partial(digits, length, output);
+}
+
+// Function to decode the body of the input in groups until the first character that is neither a digit, padding nor skipped.
+// Whole groups are converted by the kernel, a padded group ends with a short group and decoding continues after it.
+static size_t decode_group_body(const char* data, size_t size, DecoderState& state, const DecodeFormat& format, std::vector<char>& digits, unsigned char* output, size_t& consumed) {
+    const Codec& codec = *format.codec;
+    const size_t pending = state.pending_digits.length();
+    digits.resize(pending + size * (codec.zero_group != '\0' ? codec.group_chars : 1));
+    memcpy(digits.data(), state.pending_digits.data(), pending);
+    size_t count = pending + compact_group_digits(data, size, format, pending, digits.data() + pending, consumed);
+
+    size_t written = 0;
+    size_t position = 0;
+    while (count - position >= codec.group_chars) {
+        size_t groups = codec.decode_groups(digits.data() + position, (count - position) / codec.group_chars, output + written);
+        written += groups * codec.group_bytes;
+        position += groups * codec.group_chars;
+        if (count - position < codec.group_chars) {
+            break;
+        }
+
+        // The group holds padding or an invalid value
+        size_t bytes = decode_short_group(digits.data() + position, codec.group_chars, codec, output + written);
+        if (bytes == 0) {
+            consumed = locate_group_digit(data, size, codec, position > pending ? position - pending : 0);
+            count = position;
+            break;
+        }
+        written += bytes;
+        position += codec.group_chars;
+    }
+    state.pending_digits.assign(digits.data() + position, count - position);
+    return written;
+}
+
+// Function to decode the digits of the incomplete last group, they are kept if they cannot end a group
+static size_t decode_group_last(DecoderState& state, const DecodeFormat& format, unsigned char* output) {
+    if (state.pending_digits.empty()) {
+        return 0;
+    }
+    size_t bytes = decode_short_group(state.pending_digits.data(), state.pending_digits.length(), *format.codec, output);
+    if (bytes > 0) {
+        state.pending_digits.clear();
+    }
+    return bytes;
+}
+
+// Function to add the digit of value zero in place of an invalid character, returns the number of bytes
+// written when it completes a group
+static size_t replace_group_digit(DecoderState& state, const DecodeFormat& format, unsigned char* output) {
+    const Codec& codec = *format.codec;
+    state.pending_digits += codec.alphabet[0];
+    if (state.pending_digits.length() < codec.group_chars) {
+        return 0;
+    }
+    size_t groups = codec.decode_groups(state.pending_digits.data(), 1, output);
+    state.pending_digits.clear();
+    return groups * codec.group_bytes;
+}
+
+// Codecs converting groups of bytes, they share the block engine above
+const Codec BASE32_CODEC = {
+    "base32", 5, 8, BASE32_ALPHABET, BASE32_VALUES.values, '=', '\0',
+    encode_group_block, decode_group_body, decode_group_last, replace_group_digit, group_encoded_size, group_block_bound, max_group_decoded_size<5, 8, false>,
+    encode_base32_groups, decode_base32_groups, encode_base32_partial, decode_base32_partial,
+};
+
+const Codec BASE64_CODEC = {
+    "base64", 3, 4, BASE64_ALPHABET, BASE64_VALUES.values, '=', '\0',
+    encode_group_block, decode_group_body, decode_group_last, replace_group_digit, group_encoded_size, group_block_bound, max_group_decoded_size<3, 4, false>,
+    encode_base64, decode_base64, encode_base64_partial, decode_base64_partial,
+};
+
+const Codec BASE64URL_CODEC = {
+    "base64url", 3, 4, BASE64URL_ALPHABET, BASE64URL_VALUES.values, '\0', '\0',
+    encode_group_block, decode_group_body, decode_group_last, replace_group_digit, group_encoded_size, group_block_bound, max_group_decoded_size<3, 4, false>,
+    encode_base64url, decode_base64url, encode_base64url_partial, decode_base64url_partial,
+};
+
+const Codec ASCII85_CODEC = {
+    "ascii85", 4, 5, ASCII85_ALPHABET, ASCII85_VALUES.values, '\0', 'z',
+    encode_group_block, decode_group_body, decode_group_last, replace_group_digit, group_encoded_size, group_block_bound, max_group_decoded_size<4, 5, true>,
+    encode_ascii85_groups, decode_ascii85_groups, encode_ascii85_partial, decode_ascii85_partial,
+};
+
+// Table of all codecs, base16 first as the default
+static const Codec* const CODECS[] = { &BASE16_CODEC, &BASE32_CODEC, &BASE64_CODEC, &BASE64URL_CODEC, &ASCII85_CODEC };
+
+// Function to find a codec by name, or base16 if the name is empty
+const Codec* select_codec(const std::string& name) {
+    if (name.empty()) {
+        return &BASE16_CODEC;
+    }
+    for (const Codec* codec : CODECS) {
+        if (name == codec->name) {
+            return codec;
+        }
+    }
+    return nullptr;
+}
+
+// Function to get the names of all codecs separated by commas
+std::string codec_names() {
+    std::string names;
+    for (const Codec* codec : CODECS) {
+        names += (names.empty() ? "" : ", ") + std::string(codec->name);
+    }
+    return names;
+}
+
+} // namespace base16
@@ -0,0 +1,598 @@
+#include "Kernels.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define BASE16_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define TARGET_SSE2
+#define TARGET_SSE42
+#define TARGET_AVX2
+#define TARGET_AVX512
+#else
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_SSE42 __attribute__((target("sse4.2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#endif
+#endif
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define COUNT_TRAILING_ZEROS(x) _tzcnt_u32(x)
+#define COUNT_BITS(x) __popcnt(x)
+#else
+#define COUNT_TRAILING_ZEROS(x) __builtin_ctz(x)
+#define COUNT_BITS(x) __builtin_popcount(x)
+#endif
+
+namespace base16 {
+
+HexDigitTable::HexDigitTable() {
+    const char* upper_digits = "0123456789ABCDEF";
+    const char* lower_digits = "0123456789abcdef";
+    for (int i = 0; i < 256; ++i) {
+        upper[i][0] = upper_digits[i >> 4];
+        upper[i][1] = upper_digits[i & 0x0F];
+        lower[i][0] = lower_digits[i >> 4];
+        lower[i][1] = lower_digits[i & 0x0F];
+    }
+}
+
+const HexDigitTable HEX_DIGITS;
+
+// Function to convert bytes into hexadecimal digits one table lookup at a time
+void encode_scalar(const unsigned char* data, size_t size, char* output, bool upper_case) {
+    const char (*digits)[HEX_BYTE_LENGTH] = upper_case ? HEX_DIGITS.upper : HEX_DIGITS.lower;
+    for (size_t i = 0; i < size; ++i) {
+        memcpy(output + i * HEX_BYTE_LENGTH, digits[data[i]], HEX_BYTE_LENGTH);
+    }
+}
+
+HexValueTable::HexValueTable() {
+    for (int i = 0; i < 256; ++i) {
+        values[i] = -1;
+    }
+    for (int i = 0; i < 10; ++i) {
+        values['0' + i] = i;
+    }
+    for (int i = 0; i < 6; ++i) {
+        values['a' + i] = 10 + i;
+        values['A' + i] = 10 + i;
+    }
+}
+
+const HexValueTable HEX_VALUES;
+
+// Function to copy hexadecimal digits one character at a time
+size_t compact_scalar(const char* data, size_t size, const char* skip_chars, char* digits, size_t* consumed) {
+    char* out = digits;
+    size_t i = 0;
+
+    for (; i < size; ++i) {
+        unsigned char ch = data[i];
+        if (ch && strchr(skip_chars, ch)) {
+            continue; // Skipped before the digits, a separator may be a digit
+        }
+        if (HEX_VALUES.values[ch] >= 0) {
+            *out++ = ch;
+        } else if (!isspace(ch)) {
+            break; // Invalid character
+        }
+    }
+
+    *consumed = i;
+    return out - digits;
+}
+
+// Function to convert digit pairs into bytes one table lookup at a time
+void decode_scalar(const char* digits, size_t size, unsigned char* output) {
+    for (size_t i = 0; i < size; ++i) {
+        output[i] = (HEX_VALUES.values[static_cast<unsigned char>(digits[i * 2])] << 4) | HEX_VALUES.values[static_cast<unsigned char>(digits[i * 2 + 1])];
+    }
+}
+
+// Function to count line breaks in runs of 255 characters, the compiler vectorizes the byte counters
+size_t count_lines_scalar(const char* data, size_t size) {
+    size_t lines = 0;
+    for (size_t i = 0; i < size; i += 255) {
+        size_t run = std::min<size_t>(size - i, 255);
+        unsigned char count = 0;
+        for (size_t j = 0; j < run; ++j) {
+            count += data[i + j] == '\n';
+        }
+        lines += count;
+    }
+    return lines;
+}
+
+bool is_scalar_supported() {
+    return true;
+}
+
+#ifdef BASE16_X86
+// Function to convert 16 bytes per iteration, nibbles are mapped to digits with compare and add
+TARGET_SSE2 void encode_sse2(const unsigned char* data, size_t size, char* output, bool upper_case) {
+    const __m128i nibble_mask = _mm_set1_epi8(0x0F);
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i zero_digit = _mm_set1_epi8('0');
+    const __m128i letter_offset = _mm_set1_epi8(upper_case ? 'A' - '0' - 10 : 'a' - '0' - 10);
+    size_t i = 0;
+
+    for (; i + 16 <= size; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble_mask);
+        __m128i low = _mm_and_si128(bytes, nibble_mask);
+        high = _mm_add_epi8(_mm_add_epi8(high, zero_digit), _mm_and_si128(_mm_cmpgt_epi8(high, nine), letter_offset));
+        low = _mm_add_epi8(_mm_add_epi8(low, zero_digit), _mm_and_si128(_mm_cmpgt_epi8(low, nine), letter_offset));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i * 2), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i * 2 + 16), _mm_unpackhi_epi8(high, low));
+    }
+
+    encode_scalar(data + i, size - i, output + i * 2, upper_case);
+}
+
+// Function to convert 32 bytes per iteration with a shuffle-based digit lookup
+TARGET_AVX2 void encode_avx2(const unsigned char* data, size_t size, char* output, bool upper_case) {
+    const __m256i nibble_mask = _mm256_set1_epi8(0x0F);
+    const __m256i lookup = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(upper_case ? "0123456789ABCDEF" : "0123456789abcdef")));
+    size_t i = 0;
+
+    for (; i + 32 <= size; i += 32) {
+        // Reorder quadwords so that the in-lane unpacks produce contiguous output
+        __m256i bytes = _mm256_permute4x64_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), 0xD8);
+        __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble_mask));
+        __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(bytes, nibble_mask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i * 2), _mm256_unpacklo_epi8(high, low));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i * 2 + 32), _mm256_unpackhi_epi8(high, low));
+    }
+
+    _mm256_zeroupper(); // Avoid the AVX to SSE transition penalty in the tail
+    encode_sse2(data + i, size - i, output + i * 2, upper_case);
+}
+
+// Function to convert 64 bytes per iteration with a shuffle-based digit lookup
+TARGET_AVX512 void encode_avx512(const unsigned char* data, size_t size, char* output, bool upper_case) {
+    const __m512i nibble_mask = _mm512_set1_epi8(0x0F);
+    const __m512i lookup = _mm512_loadu_si512(upper_case
+        ? "0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF"
+        : "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef");
+    const __m512i order = _mm512_set_epi64(7, 3, 6, 2, 5, 1, 4, 0);
+    size_t i = 0;
+
+    for (; i + 64 <= size; i += 64) {
+        // Reorder quadwords so that the in-lane unpacks produce contiguous output
+        __m512i bytes = _mm512_permutexvar_epi64(order, _mm512_loadu_si512(data + i));
+        __m512i high = _mm512_shuffle_epi8(lookup, _mm512_and_si512(_mm512_srli_epi16(bytes, 4), nibble_mask));
+        __m512i low = _mm512_shuffle_epi8(lookup, _mm512_and_si512(bytes, nibble_mask));
+        _mm512_storeu_si512(output + i * 2, _mm512_unpacklo_epi8(high, low));
+        _mm512_storeu_si512(output + i * 2 + 64, _mm512_unpackhi_epi8(high, low));
+    }
+
+    encode_avx2(data + i, size - i, output + i * 2, upper_case);
+}
+
+// Table of shuffle patterns moving the selected bytes of an 8-byte group to its beginning
+struct CompactShuffleTable {
+    unsigned char patterns[256][8];
+
+    CompactShuffleTable() {
+        for (int mask = 0; mask < 256; ++mask) {
+            int count = 0;
+            for (int bit = 0; bit < 8; ++bit) {
+                if (mask & (1 << bit)) {
+                    patterns[mask][count++] = bit;
+                }
+            }
+            while (count < 8) {
+                patterns[mask][count++] = 0x80;
+            }
+        }
+    }
+};
+
+const CompactShuffleTable COMPACT_SHUFFLES;
+
+// Function to copy hexadecimal digits classifying 16 characters per iteration
+TARGET_SSE2 size_t compact_sse2(const char* data, size_t size, const char* skip_chars, char* digits, size_t* consumed) {
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    __m128i skips[MAX_SKIP_CHARS];
+    size_t skip_count = 0;
+    for (; skip_count < MAX_SKIP_CHARS && skip_chars[skip_count]; ++skip_count) {
+        skips[skip_count] = _mm_set1_epi8(skip_chars[skip_count]);
+    }
+    char* out = digits;
+    size_t i = 0;
+
+    for (; i + 16 <= size; i += 16) {
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+        __m128i letter = _mm_sub_epi8(_mm_or_si128(chars, case_bit), _mm_set1_epi8('a'));
+        __m128i control = _mm_sub_epi8(chars, _mm_set1_epi8('\t'));
+        __m128i hex = _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit), _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter));
+        __m128i skip = _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(_mm_min_epu8(control, _mm_set1_epi8(4)), control));
+        for (size_t k = 0; k < skip_count; ++k) {
+            skip = _mm_or_si128(skip, _mm_cmpeq_epi8(chars, skips[k]));
+        }
+        hex = _mm_andnot_si128(skip, hex); // A skipped character is no digit
+        unsigned hex_mask = _mm_movemask_epi8(hex);
+        if (_mm_movemask_epi8(_mm_or_si128(hex, skip)) != 0xFFFF) {
+            break; // The scalar loop locates the invalid character
+        }
+        if (hex_mask == 0xFFFF) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), chars);
+            out += 16;
+            continue;
+        }
+        while (hex_mask) {
+            *out++ = data[i + COUNT_TRAILING_ZEROS(hex_mask)];
+            hex_mask &= hex_mask - 1;
+        }
+    }
+
+    size_t tail_consumed;
+    out += compact_scalar(data + i, size - i, skip_chars, out, &tail_consumed);
+    *consumed = i + tail_consumed;
+    return out - digits;
+}
+
+// Function to convert 32 digits into 16 bytes per iteration
+TARGET_SSE2 void decode_sse2(const char* digits, size_t size, unsigned char* output) {
+    const __m128i low_byte = _mm_set1_epi16(0x00FF);
+    size_t i = 0;
+
+    for (; i + 16 <= size; i += 16) {
+        __m128i words[2];
+        for (int j = 0; j < 2; ++j) {
+            __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(digits + i * 2 + j * 16));
+            __m128i letter = _mm_cmpgt_epi8(chars, _mm_set1_epi8('9'));
+            __m128i values = _mm_sub_epi8(_mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('0')), _mm_and_si128(letter, _mm_set1_epi8('a' - '0' - 10)));
+            words[j] = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(values, low_byte), 4), _mm_srli_epi16(values, 8));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_packus_epi16(words[0], words[1]));
+    }
+
+    decode_scalar(digits + i * 2, size - i, output + i);
+}
+
+// Function to count line breaks 16 characters per iteration in byte counters summed every 255 iterations
+TARGET_SSE2 size_t count_lines_sse2(const char* data, size_t size) {
+    size_t lines = 0;
+    size_t i = 0;
+
+    while (i + 16 <= size) {
+        __m128i counts = _mm_setzero_si128();
+        for (int k = 0; k < 255 && i + 16 <= size; ++k, i += 16) {
+            __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(chars, _mm_set1_epi8('\n')));
+        }
+        __m128i sums = _mm_sad_epu8(counts, _mm_setzero_si128());
+        lines += _mm_cvtsi128_si32(sums) + _mm_extract_epi16(sums, 4);
+    }
+
+    return lines + count_lines_scalar(data + i, size - i);
+}
+
+// Function to copy hexadecimal digits classifying 32 characters per iteration and packing them with shuffles
+TARGET_AVX2 size_t compact_avx2(const char* data, size_t size, const char* skip_chars, char* digits, size_t* consumed) {
+    const __m256i case_bit = _mm256_set1_epi8(0x20);
+    __m256i skips[MAX_SKIP_CHARS];
+    size_t skip_count = 0;
+    for (; skip_count < MAX_SKIP_CHARS && skip_chars[skip_count]; ++skip_count) {
+        skips[skip_count] = _mm256_set1_epi8(skip_chars[skip_count]);
+    }
+    char* out = digits;
+    size_t i = 0;
+
+    for (; i + 32 <= size; i += 32) {
+        __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+        __m256i letter = _mm256_sub_epi8(_mm256_or_si256(chars, case_bit), _mm256_set1_epi8('a'));
+        __m256i control = _mm256_sub_epi8(chars, _mm256_set1_epi8('\t'));
+        __m256i hex = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit), _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter));
+        __m256i skip = _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(_mm256_min_epu8(control, _mm256_set1_epi8(4)), control));
+        for (size_t k = 0; k < skip_count; ++k) {
+            skip = _mm256_or_si256(skip, _mm256_cmpeq_epi8(chars, skips[k]));
+        }
+        hex = _mm256_andnot_si256(skip, hex); // A skipped character is no digit
+        unsigned hex_mask = _mm256_movemask_epi8(hex);
+        if (static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(hex, skip))) != 0xFFFFFFFF) {
+            break; // The scalar loop locates the invalid character
+        }
+        if (hex_mask == 0xFFFFFFFF) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), chars);
+            out += 32;
+            continue;
+        }
+        for (int group = 0; group < 4; ++group) {
+            unsigned group_mask = (hex_mask >> (group * 8)) & 0xFF;
+            __m128i source = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data + i + group * 8));
+            __m128i pattern = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(COMPACT_SHUFFLES.patterns[group_mask]));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(source, pattern));
+            out += COUNT_BITS(group_mask);
+        }
+    }
+
+    size_t tail_consumed;
+    _mm256_zeroupper(); // Avoid the AVX to SSE transition penalty in the tail
+    out += compact_sse2(data + i, size - i, skip_chars, out, &tail_consumed);
+    *consumed = i + tail_consumed;
+    return out - digits;
+}
+
+// Function to convert 64 digits into 32 bytes per iteration
+TARGET_AVX2 void decode_avx2(const char* digits, size_t size, unsigned char* output) {
+    const __m256i weights = _mm256_set1_epi16(0x0110); // High digit * 16 + low digit
+    size_t i = 0;
+
+    for (; i + 32 <= size; i += 32) {
+        __m256i words[2];
+        for (int j = 0; j < 2; ++j) {
+            __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(digits + i * 2 + j * 32));
+            __m256i letter = _mm256_cmpgt_epi8(chars, _mm256_set1_epi8('9'));
+            __m256i values = _mm256_sub_epi8(_mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('0')), _mm256_and_si256(letter, _mm256_set1_epi8('a' - '0' - 10)));
+            words[j] = _mm256_maddubs_epi16(values, weights);
+        }
+        __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(words[0], words[1]), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), bytes);
+    }
+
+    _mm256_zeroupper(); // Avoid the AVX to SSE transition penalty in the tail
+    decode_sse2(digits + i * 2, size - i, output + i);
+}
+
+// Function to count line breaks 32 characters per iteration in byte counters summed every 255 iterations
+TARGET_AVX2 size_t count_lines_avx2(const char* data, size_t size) {
+    size_t lines = 0;
+    size_t i = 0;
+
+    while (i + 32 <= size) {
+        __m256i counts = _mm256_setzero_si256();
+        for (int k = 0; k < 255 && i + 32 <= size; ++k, i += 32) {
+            __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            counts = _mm256_sub_epi8(counts, _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\n')));
+        }
+        __m256i sums = _mm256_sad_epu8(counts, _mm256_setzero_si256());
+        __m128i halves = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+        lines += _mm_cvtsi128_si32(halves) + _mm_extract_epi16(halves, 4);
+    }
+
+    _mm256_zeroupper(); // Avoid the AVX to SSE transition penalty in the tail
+    return lines + count_lines_sse2(data + i, size - i);
+}
+
+// Function to copy hexadecimal digits classifying 64 characters per iteration with mask compares
+TARGET_AVX512 size_t compact_avx512(const char* data, size_t size, const char* skip_chars, char* digits, size_t* consumed) {
+    const __m512i case_bit = _mm512_set1_epi8(0x20);
+    __m512i skips[MAX_SKIP_CHARS];
+    size_t skip_count = 0;
+    for (; skip_count < MAX_SKIP_CHARS && skip_chars[skip_count]; ++skip_count) {
+        skips[skip_count] = _mm512_set1_epi8(skip_chars[skip_count]);
+    }
+    char* out = digits;
+    size_t i = 0;
+
+    for (; i + 64 <= size; i += 64) {
+        __m512i chars = _mm512_loadu_si512(data + i);
+        __mmask64 hex = _mm512_cmple_epu8_mask(_mm512_sub_epi8(chars, _mm512_set1_epi8('0')), _mm512_set1_epi8(9))
+            | _mm512_cmple_epu8_mask(_mm512_sub_epi8(_mm512_or_si512(chars, case_bit), _mm512_set1_epi8('a')), _mm512_set1_epi8(5));
+        __mmask64 skip = _mm512_cmpeq_epi8_mask(chars, _mm512_set1_epi8(' '))
+            | _mm512_cmple_epu8_mask(_mm512_sub_epi8(chars, _mm512_set1_epi8('\t')), _mm512_set1_epi8(4));
+        for (size_t k = 0; k < skip_count; ++k) {
+            skip |= _mm512_cmpeq_epi8_mask(chars, skips[k]);
+        }
+        hex &= ~skip; // A skipped character is no digit
+        if (~(hex | skip)) {
+            break; // The scalar loop locates the invalid character
+        }
+        if (~hex == 0) {
+            _mm512_storeu_si512(out, chars);
+            out += 64;
+            continue;
+        }
+        for (int group = 0; group < 8; ++group) {
+            unsigned group_mask = (hex >> (group * 8)) & 0xFF;
+            __m128i source = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data + i + group * 8));
+            __m128i pattern = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(COMPACT_SHUFFLES.patterns[group_mask]));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(source, pattern));
+            out += COUNT_BITS(group_mask);
+        }
+    }
+
+    size_t tail_consumed;
+    out += compact_avx2(data + i, size - i, skip_chars, out, &tail_consumed);
+    *consumed = i + tail_consumed;
+    return out - digits;
+}
+
+// Function to convert 128 digits into 64 bytes per iteration
+TARGET_AVX512 void decode_avx512(const char* digits, size_t size, unsigned char* output) {
+    const __m512i weights = _mm512_set1_epi16(0x0110); // High digit * 16 + low digit
+    const __m512i order = _mm512_set_epi64(7, 5, 3, 1, 6, 4, 2, 0);
+    size_t i = 0;
+
+    for (; i + 64 <= size; i += 64) {
+        __m512i words[2];
+        for (int j = 0; j < 2; ++j) {
+            __m512i chars = _mm512_loadu_si512(digits + i * 2 + j * 64);
+            __mmask64 letter = _mm512_cmpgt_epi8_mask(chars, _mm512_set1_epi8('9'));
+            __m512i values = _mm512_sub_epi8(_mm512_or_si512(chars, _mm512_set1_epi8(0x20)), _mm512_set1_epi8('0'));
+            values = _mm512_mask_sub_epi8(values, letter, values, _mm512_set1_epi8('a' - '0' - 10));
+            words[j] = _mm512_maddubs_epi16(values, weights);
+        }
+        __m512i bytes = _mm512_permutexvar_epi64(order, _mm512_packus_epi16(words[0], words[1]));
+        _mm512_storeu_si512(output + i, bytes);
+    }
+
+    decode_avx2(digits + i * 2, size - i, output + i);
+}
+
+#if defined(_MSC_VER) && !defined(__clang__)
+// Function to check CPUID feature bits together with the register state enabled by the OS
+bool has_cpu_feature(int leaf, int reg, int bit, unsigned long long xcr0_mask) {
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < leaf) {
+        return false;
+    }
+    __cpuidex(info, leaf, 0);
+    if (!(info[reg] & (1 << bit))) {
+        return false;
+    }
+    if (xcr0_mask) {
+        __cpuid(info, 1);
+        if (!(info[2] & (1 << 27))) { // OSXSAVE
+            return false;
+        }
+        return (_xgetbv(0) & xcr0_mask) == xcr0_mask;
+    }
+    return true;
+}
+
+bool is_sse2_supported() {
+    return has_cpu_feature(1, 3, 26, 0);
+}
+
+bool is_sse42_supported() {
+    return has_cpu_feature(1, 2, 20, 0);
+}
+
+bool is_avx2_supported() {
+    return has_cpu_feature(7, 1, 5, 0x6);
+}
+
+bool is_avx512_supported() {
+    return has_cpu_feature(7, 1, 16, 0xE6) && has_cpu_feature(7, 1, 30, 0xE6);
+}
+#else
+bool is_sse2_supported() {
+    return __builtin_cpu_supports("sse2");
+}
+
+bool is_sse42_supported() {
+    return __builtin_cpu_supports("sse4.2");
+}
+
+bool is_avx2_supported() {
+    return __builtin_cpu_supports("avx2");
+}
+
+bool is_avx512_supported() {
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+}
+#endif
+#endif
+
+// Available kernels, from the most to the least capable
+const Kernel KERNELS[] = {
+#ifdef BASE16_X86
+    { "avx512", encode_avx512, compact_avx512, decode_avx512, count_lines_avx2, is_avx512_supported },
+    { "avx2", encode_avx2, compact_avx2, decode_avx2, count_lines_avx2, is_avx2_supported },
+    { "sse2", encode_sse2, compact_sse2, decode_sse2, count_lines_sse2, is_sse2_supported },
+#endif
+    { "scalar", encode_scalar, compact_scalar, decode_scalar, count_lines_scalar, is_scalar_supported },
+};
+
+// Function to find a kernel by name, or the best one supported by the CPU if the name is empty
+const Kernel* select_kernel(const std::string& name) {
+    for (const Kernel& kernel : KERNELS) {
+        if ((name.empty() || name == kernel.name) && kernel.is_supported()) {
+            return &kernel;
+        }
+    }
+    return nullptr;
+}
+
+Crc32cTable::Crc32cTable() {
+    const unsigned int polynomial = 0x82F63B78; // Reflected Castagnoli polynomial
+    for (unsigned int i = 0; i < 256; ++i) {
+        unsigned int crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = crc & 1 ? (crc >> 1) ^ polynomial : crc >> 1;
+        }
+        values[0][i] = crc;
+    }
+    for (int k = 1; k < 8; ++k) {
+        for (int i = 0; i < 256; ++i) {
+            values[k][i] = (values[k - 1][i] >> 8) ^ values[0][values[k - 1][i] & 0xFF];
+        }
+    }
+}
+
+const Crc32cTable CRC32C_TABLE;
+
+// Function to update a CRC-32C eight bytes at a time with eight table lookups
+unsigned int crc32c_scalar(unsigned int crc, const unsigned char* data, size_t size) {
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        unsigned long long word;
+        memcpy(&word, data + i, sizeof(word));
+        word ^= crc; // Little-endian: the first four bytes take the running CRC
+        crc = CRC32C_TABLE.values[7][word & 0xFF] ^ CRC32C_TABLE.values[6][(word >> 8) & 0xFF]
+            ^ CRC32C_TABLE.values[5][(word >> 16) & 0xFF] ^ CRC32C_TABLE.values[4][(word >> 24) & 0xFF]
+            ^ CRC32C_TABLE.values[3][(word >> 32) & 0xFF] ^ CRC32C_TABLE.values[2][(word >> 40) & 0xFF]
+            ^ CRC32C_TABLE.values[1][(word >> 48) & 0xFF] ^ CRC32C_TABLE.values[0][word >> 56];
+    }
+    for (; i < size; ++i) {
+        crc = (crc >> 8) ^ CRC32C_TABLE.values[0][(crc ^ data[i]) & 0xFF];
+    }
+    return crc;
+}
+
+#if defined(BASE16_X86) && (defined(__x86_64__) || defined(_M_X64))
+// Function to update a CRC-32C with the crc32 instruction, eight bytes at a time
+TARGET_SSE42 unsigned int crc32c_sse42(unsigned int crc, const unsigned char* data, size_t size) {
+    unsigned long long crc64 = crc;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        unsigned long long word;
+        memcpy(&word, data + i, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = static_cast<unsigned int>(crc64);
+    for (; i < size; ++i) {
+        crc = _mm_crc32_u8(crc, data[i]);
+    }
+    return crc;
+}
+#endif
+
+#if defined(__ARM_FEATURE_CRC32)
+// Function to update a CRC-32C with the crc32c instructions, eight bytes at a time
+unsigned int crc32c_arm(unsigned int crc, const unsigned char* data, size_t size) {
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        unsigned long long word;
+        memcpy(&word, data + i, sizeof(word));
+        crc = __crc32cd(crc, word);
+    }
+    for (; i < size; ++i) {
+        crc = __crc32cb(crc, data[i]);
+    }
+    return crc;
+}
+#endif
+
+// Function to select the fastest CRC-32C implementation supported by the CPU
+static Crc32cKernel select_crc32c() {
+#if defined(BASE16_X86) && (defined(__x86_64__) || defined(_M_X64))
+    if (is_sse42_supported()) {
+        return crc32c_sse42;
+    }
+#endif
+#if defined(__ARM_FEATURE_CRC32)
+    return crc32c_arm;
+#endif
+    return crc32c_scalar;
+}
+
+const Crc32cKernel crc32c_update = select_crc32c();
+
+} // namespace base16
@@ -0,0 +1,40 @@
+#ifndef BASE16_KERNELS_H
+#define BASE16_KERNELS_H
+
+#include "Base16.h"
+
+namespace base16 {
+
+// Table of two-digit hexadecimal representations for every byte value
+struct HexDigitTable {
+    char upper[256][HEX_BYTE_LENGTH];
+    char lower[256][HEX_BYTE_LENGTH];
+
+    HexDigitTable();
+};
+
+// Table of hexadecimal digit values for every character, -1 for non-digits
+struct HexValueTable {
+    signed char values[256];
+
+    HexValueTable();
+};
+
+// Table of the CRC-32C of every byte value, advanced by up to seven zero bytes
+struct Crc32cTable {
+    unsigned int values[8][256];
+
+    Crc32cTable();
+};
+
+// Function type of a kernel updating a CRC-32C without the initial and final inversion
+typedef unsigned int (*Crc32cKernel)(unsigned int crc, const unsigned char* data, size_t size);
+
+extern const HexDigitTable HEX_DIGITS;
+extern const HexValueTable HEX_VALUES;
+extern const Crc32cKernel crc32c_update; // Fastest CRC-32C kernel supported by the CPU
+extern const Codec BASE16_CODEC; // Codec of hexadecimal digits converted by the kernel of the parameters
+
+} // namespace base16
+
+#endif // BASE16_KERNELS_H
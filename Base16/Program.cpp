@@ -5,42 +5,137 @@
 #include <vector>
 #include <string>
 #include <cctype>
+#include <cerrno>
 #include <csignal>
 #include <algorithm>
 #include <set>
+#include <map>
 #include <stdexcept>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <deque>
+#include <climits>
+#include <cstdint>
+#include <filesystem>
+#include <atomic>
+#include <chrono>
+
+#include "Base16.h"
 
 #ifdef _WIN32
 #include <windows.h>
+#include <psapi.h>
 #include <io.h>
-#define NEWLINE "\r\n"
+#include <fcntl.h>
+#include <sys/stat.h>
 #else
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
 #include <unistd.h>
-#define NEWLINE "\n"
 #endif
 
-#define STRLINE(str) (std::string(str) + NEWLINE)
+#ifdef __linux__
+#include <sys/vfs.h>
+#endif
+
+using namespace base16;
 
 // Constants
 const int DEFAULT_CONSOLE_WIDTH = 80;
-const int HEX_BYTE_LENGTH = 2;
-const int SEPARATOR_LENGTH = 1;
 const std::string VERSION = "1.0a";
+const size_t PARALLEL_CHUNK_SIZE = 1024 * 1024; // Number of input bytes processed by one worker task
+const size_t OUTPUT_BUFFER_SIZE = 1024 * 1024; // Size of the user-space output buffer
+const size_t PIPELINE_BLOCK_SIZE = 1024 * 1024; // Number of input bytes read by one pipeline read
+const size_t PIPELINE_DEPTH = 4; // Number of buffers in flight between two pipeline stages
+const size_t MAX_LAYOUT_LINE_LENGTH = 1024 * 1024; // Longest first line of an encoded file used to seek to a decoded byte range
+const size_t DIGEST_TAIL_SIZE = 4 * MAX_DIGEST_LINE; // Characters at the end of an encoded file searched for a digest trailer
+const size_t RECORD_READ_SIZE = 1024 * 1024; // Largest read of record input, the records that arrive with it form a batch
+const size_t MAX_FRAME_SIZE = 1024 * 1024; // Largest payload of a frame between the server and a client
+const size_t MIN_MEMORY_LIMIT = 4 * 1024; // Smallest memory limit of -mem
+const size_t MIN_LIMITED_BLOCK_SIZE = 256; // Smallest block converted under the memory limit of -mem
+
+// Frame types of the server protocol. A frame is the type, the payload size as four little-endian bytes and the payload.
+const char FRAME_ARGUMENT = 'A'; // Client: one command-line argument, the first is the program name
+const char FRAME_DIRECTORY = 'C'; // Client: working directory
+const char FRAME_WIDTH = 'W'; // Client: console width
+const char FRAME_RUN = 'R'; // Client: end of the request, the payload is 1 when the standard input is redirected
+const char FRAME_INPUT = 'I'; // Server: request for the standard input; client: input data, an empty frame ends it
+const char FRAME_OUTPUT = 'O'; // Server: standard output data
+const char FRAME_ERRORS = 'E'; // Server: standard error data
+const char FRAME_EXIT = 'X'; // Server: exit code, the last frame of a request
+
+// Stages of a conversion measured for -stats
+enum class Stage {
+    Read, // Reading input files and the standard input
+    Transform, // Encoding or decoding
+    Write, // Writing the output
+};
+
+// Counters collected for -stats and -progress, updated by every thread
+struct Statistics {
+    bool enabled = false; // Flag to collect the counters
+    std::atomic<long long> nanoseconds[3]; // Time spent in every stage, summed over all threads
+    std::atomic<unsigned long long> bytes[3]; // Bytes read, converted and written
+    std::atomic<bool> mapped_output{false}; // Flag set when an output file was written through a mapping at computed offsets
+};
+
+// Streams, counters and working directory of one command. The command line runs a single session, the
+// server one per request; every thread working for a request refers to its session.
+struct Session {
+    std::ostream* console = &std::cout; // Help text
+    std::ostream* errors = &std::cerr; // Messages, statistics and progress lines
+    Statistics statistics; // Counters of -stats and -progress
+    std::filesystem::path directory; // Working directory of a client, empty for the current directory
+};
+
+Session process_session;
+thread_local Session* session = &process_session;
+
+// Function to resolve a file name against the working directory of the session
+std::string session_path(const std::string& name) {
+    if (session->directory.empty() || std::filesystem::path(name).is_absolute()) {
+        return name;
+    }
+    return (session->directory / name).string();
+}
+
+// Timer adding the time between its construction and stop() or destruction to a stage of the statistics
+class StageTimer {
+public:
+    explicit StageTimer(Stage stage, size_t bytes = 0) : stage(static_cast<int>(stage)), running(session->statistics.enabled) {
+        if (running) {
+            start = std::chrono::steady_clock::now();
+            session->statistics.bytes[this->stage] += bytes;
+        }
+    }
+
+    ~StageTimer() {
+        stop();
+    }
+
+    void stop() {
+        if (running) {
+            session->statistics.nanoseconds[stage] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            running = false;
+        }
+    }
 
-// Structure to hold parameters for encoding/decoding
-struct Parameters {
-    bool encode_mode; // Flag to indicate encoding mode
-    bool upper_case; // Flag to indicate uppercase hexadecimal digits
-    char separator; // Single character separator
-    std::string prefix; // Prefix for each byte
-    std::string postfix; // Postfix for each byte
-    std::string header; // Header for the entire output
-    std::string footer; // Footer for the entire output
-    bool suppress_last_postfix; // Flag to suppress postfix for the last byte
-    int max_columns; // Maximum number of columns (bytes) per line
-    int max_chars; // Maximum number of characters per line
-    std::string file_extension; // File extension for output
+private:
+    int stage;
+    bool running;
+    std::chrono::steady_clock::time_point start;
 };
 
 bool is_stdin_redirected() {
@@ -51,6 +146,356 @@ bool is_stdin_redirected() {
 #endif
 }
 
+// Structure to hold a read-only memory mapping of an input file
+struct MappedFile {
+    const char* data; // First byte of the mapping
+    size_t size; // Size of the file in bytes
+};
+
+// How input files are read
+enum class InputMode {
+    Auto, // Map local regular files into memory, read other files with the pipeline
+    Map, // Map every regular file into memory
+    Pipeline, // Read files on a reader thread overlapping the conversion
+    Stream, // Read files through an unbuffered stream in blocks of the block size, used by -mem
+};
+
+// How the input is split into records converted one by one
+enum class RecordMode {
+    None, // The whole input is one piece of data
+    Lines, // Records end with a line break
+    Nul, // Records end with a zero byte
+    Len32, // Records start with their size as four little-endian bytes
+};
+
+// Function to check whether a file is on a network file system, where page faults of a mapping would stall the conversion
+bool is_network_file(int fd) {
+#ifdef __linux__
+    struct statfs st;
+    if (fstatfs(fd, &st) != 0) {
+        return false;
+    }
+    switch (static_cast<unsigned long>(st.f_type)) {
+    case 0x6969: // NFS
+    case 0x517B: // SMB
+    case 0xFF534D42: // CIFS
+    case 0xFE534D42: // SMB2
+    case 0x65735546: // FUSE
+        return true;
+    }
+#endif
+    return false;
+}
+
+// Function to map a regular file into memory, returns nullptr for pipes, special files or on failure.
+// Files on network file systems are only mapped in Map mode.
+MappedFile* map_file(const std::string& file_name, InputMode mode) {
+#ifdef _WIN32
+    return nullptr; // Buffered reads are used on Windows
+#else
+    if (mode == InputMode::Pipeline || mode == InputMode::Stream) {
+        return nullptr;
+    }
+    StageTimer timer(Stage::Read); // Pages are read later by the conversion
+    int fd = open(session_path(file_name).c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (mode == InputMode::Auto && is_network_file(fd))) {
+        close(fd);
+        return nullptr;
+    }
+
+    MappedFile* file = new MappedFile{ nullptr, static_cast<size_t>(st.st_size) };
+    if (file->size > 0) {
+        void* data = mmap(nullptr, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            delete file;
+            return nullptr;
+        }
+        madvise(data, file->size, MADV_SEQUENTIAL);
+        file->data = static_cast<const char*>(data);
+    }
+
+    close(fd);
+    return file;
+#endif
+}
+
+// Function to release a file mapped with map_file
+void unmap_file(MappedFile* file) {
+#ifndef _WIN32
+    if (file->size > 0) {
+        munmap(const_cast<char*>(file->data), file->size);
+    }
+#endif
+    delete file;
+}
+
+// When the buffered output is written to the file
+enum class FlushPolicy {
+    Line, // At every line break and every flush of the stream
+    Block, // When the buffer is full and at every flush of the stream, once per converted block
+    None, // Only when the buffer is full and at the end of the output
+};
+
+// Function to check whether a file descriptor refers to a terminal
+bool is_terminal(int fd) {
+#ifdef _WIN32
+    return _isatty(fd) != 0;
+#else
+    return isatty(fd) != 0;
+#endif
+}
+
+// Function to open an output file, returns -1 on failure. The file is opened for reading too, so that it can be
+// mapped and written at computed offsets; a file that may only be written is written through the buffer.
+int open_output_file(const std::string& file_name) {
+#ifdef _WIN32
+    return _open(session_path(file_name).c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_TEXT, _S_IREAD | _S_IWRITE);
+#else
+    int fd = open(session_path(file_name).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0 && errno == EACCES) {
+        fd = open(session_path(file_name).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    }
+    return fd;
+#endif
+}
+
+#ifdef _WIN32
+class Connection; // The server is not available on Windows
+#else
+// Connection between the server and a client. Frames sent by the threads of a request are never interleaved.
+class Connection {
+public:
+    explicit Connection(int fd) : fd(fd) {}
+
+    ~Connection() {
+        close(fd);
+    }
+
+    // Function to send pieces of data as frames of one type, empty pieces are skipped
+    bool send(char type, const char* const* pieces, const size_t* sizes, int count) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int i = 0; i < count; ++i) {
+            for (size_t offset = 0; offset < sizes[i]; offset += MAX_FRAME_SIZE) {
+                if (!send_frame(type, pieces[i] + offset, std::min(sizes[i] - offset, MAX_FRAME_SIZE))) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Function to send one frame, or several for data larger than MAX_FRAME_SIZE
+    bool send(char type, const char* data, size_t size) {
+        if (size == 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return send_frame(type, data, 0);
+        }
+        return send(type, &data, &size, 1);
+    }
+
+    bool send(char type, const std::string& payload) {
+        return send(type, payload.data(), payload.size());
+    }
+
+    // Function to receive the next frame, returns false at the end of the connection or for a malformed frame
+    bool receive(char& type, std::vector<char>& payload) {
+        unsigned char header[5];
+        if (!read_all(reinterpret_cast<char*>(header), sizeof(header))) {
+            return false;
+        }
+        size_t size = header[1] | header[2] << 8 | header[3] << 16 | static_cast<size_t>(header[4]) << 24;
+        if (size > MAX_FRAME_SIZE) {
+            return false;
+        }
+        type = static_cast<char>(header[0]);
+        payload.resize(size);
+        return read_all(payload.data(), size);
+    }
+
+private:
+    bool send_frame(char type, const char* data, size_t size) {
+        char header[5] = { type, static_cast<char>(size), static_cast<char>(size >> 8), static_cast<char>(size >> 16), static_cast<char>(size >> 24) };
+        const char* chunks[2] = { header, data };
+        size_t sizes[2] = { sizeof(header), size };
+        while (!failed && sizes[0] + sizes[1] > 0) {
+            struct iovec vectors[2] = { { const_cast<char*>(chunks[0]), sizes[0] }, { const_cast<char*>(chunks[1]), sizes[1] } };
+            int first = sizes[0] > 0 ? 0 : 1;
+            ssize_t length = writev(fd, vectors + first, 2 - first);
+            if (length < 0 && errno == EINTR) {
+                continue;
+            }
+            if (length <= 0) {
+                failed = true;
+                break;
+            }
+            for (int i = 0; i < 2; ++i) {
+                size_t written = std::min<size_t>(sizes[i], length);
+                chunks[i] += written;
+                sizes[i] -= written;
+                length -= written;
+            }
+        }
+        return !failed;
+    }
+
+    bool read_all(char* data, size_t size) {
+        while (size > 0) {
+            ssize_t length = read(fd, data, size);
+            if (length < 0 && errno == EINTR) {
+                continue;
+            }
+            if (length <= 0) {
+                return false;
+            }
+            data += length;
+            size -= length;
+        }
+        return true;
+    }
+
+    int fd;
+    std::mutex mutex;
+    bool failed = false; // Flag set when the client is gone, later frames are dropped
+};
+#endif
+
+// Stream buffer collecting the output in a large user-space buffer. The buffer and data that does
+// not fit into it are written with a single writev call; flushes of the stream follow the flush policy.
+// The output of a served request is sent to the client as output frames instead.
+class OutputBuffer : public std::streambuf {
+public:
+    OutputBuffer(int fd, bool owns_fd, FlushPolicy policy, Connection* connection = nullptr, size_t buffer_size = OUTPUT_BUFFER_SIZE)
+        : fd(fd), owns_fd(owns_fd), policy(policy), connection(connection), buffer(buffer_size) {
+        setp(buffer.data(), buffer.data() + buffer.size());
+    }
+
+    ~OutputBuffer() {
+        finish();
+        if (owns_fd) {
+#ifdef _WIN32
+            _close(fd);
+#else
+            close(fd);
+#endif
+        }
+    }
+
+    // Function to write all buffered output regardless of the flush policy, returns false on write errors
+    bool finish() {
+        return write_out(nullptr, 0) && !failed;
+    }
+
+    // Function to get the descriptor of the output file if it is a regular file that nothing was written to yet,
+    // -1 otherwise. Such a file can be written at explicit offsets instead of through the buffer.
+    int empty_file() const {
+#ifndef _WIN32
+        struct stat st;
+        if (owns_fd && connection == nullptr && !failed && pptr() == pbase() && fstat(fd, &st) == 0 && S_ISREG(st.st_mode)
+            && st.st_size == 0 && lseek(fd, 0, SEEK_CUR) == 0) {
+            return fd;
+        }
+#endif
+        return -1;
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!write_out(nullptr, 0)) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char* data, std::streamsize size) override {
+        if (size > epptr() - pptr()) {
+            // Large pieces go straight to the file behind the buffered data
+            return write_out(data, size) ? size : 0;
+        }
+        memcpy(pptr(), data, size);
+        pbump(static_cast<int>(size));
+        if (policy == FlushPolicy::Line && memchr(data, '\n', size) != nullptr) {
+            return write_out(nullptr, 0) ? size : 0;
+        }
+        return size;
+    }
+
+    int sync() override {
+        if (policy == FlushPolicy::None) {
+            return 0;
+        }
+        return write_out(nullptr, 0) ? 0 : -1;
+    }
+
+private:
+    // Function to write the buffered data followed by the given data
+    bool write_out(const char* data, size_t size) {
+        const char* chunks[2] = { pbase(), data };
+        size_t sizes[2] = { static_cast<size_t>(pptr() - pbase()), size };
+        setp(buffer.data(), buffer.data() + buffer.size());
+        if (failed) {
+            return false;
+        }
+        StageTimer timer(Stage::Write, sizes[0] + sizes[1]);
+
+#ifdef _WIN32
+        for (int i = 0; i < 2; ++i) {
+            while (sizes[i] > 0) {
+                int length = _write(fd, chunks[i], static_cast<unsigned int>(std::min<size_t>(sizes[i], INT_MAX)));
+                if (length <= 0) {
+                    failed = true;
+                    return false;
+                }
+                chunks[i] += length;
+                sizes[i] -= length;
+            }
+        }
+#else
+        if (connection != nullptr) {
+            failed = !connection->send(FRAME_OUTPUT, chunks, sizes, 2);
+            return !failed;
+        }
+        while (sizes[0] + sizes[1] > 0) {
+            struct iovec vectors[2] = { { const_cast<char*>(chunks[0]), sizes[0] }, { const_cast<char*>(chunks[1]), sizes[1] } };
+            int first = sizes[0] > 0 ? 0 : 1;
+            ssize_t length = writev(fd, vectors + first, 2 - first);
+            if (length < 0 && errno == EINTR) {
+                continue;
+            }
+            if (length <= 0) {
+                failed = true;
+                return false;
+            }
+
+            // Skip the part that was written
+            for (int i = 0; i < 2; ++i) {
+                size_t written = std::min<size_t>(sizes[i], length);
+                chunks[i] += written;
+                sizes[i] -= written;
+                length -= written;
+            }
+        }
+#endif
+        return true;
+    }
+
+    int fd;
+    bool owns_fd;
+    FlushPolicy policy;
+    Connection* connection;
+    std::vector<char> buffer;
+    bool failed = false;
+};
+
 // Function to print messages with line wrapping and handling of non-breaking spaces
 void print_message(std::ostream& output, const std::string& message, int max_line_length) {
     std::istringstream iss(message);
@@ -96,44 +541,67 @@ void print_separator_line(std::ostream& output, int max_chars) {
 
 // Function to print help message
 void print_help(const std::string& program_name, int max_line_length) {
-    print_message(std::cout, program_name + " ver. " + VERSION, max_line_length);
-    print_message(std::cout, "Copyright (C) 2024 Pavel_Bashkardin", max_line_length);
-    print_message(std::cout, "Description:", max_line_length);
-    print_message(std::cout, "The BASE16 program is a command-line utility for encoding and decoding data in hex (hexadecimal) format. It supports various parameters and keys for configuring the encoding and decoding process, as well as formatting the output in different programming languages.", max_line_length);
-    print_separator_line(std::cout, max_line_length);
-
-    print_message(std::cout, "Usage:", max_line_length);
-    print_message(std::cout, program_name + " [-e|-encode|-d|-decode] [-u|-ucase|-l|-lcase] [-s|-separator_separator] [-prefix_prefix] [-postfix_postfix] [-header_header] [-footer_footer] [-lang|-language_language] [-t|-text_text|-f|-file_file|-o|-output_output|-c|-columns_columns|-i|-input] [-h|-help]", max_line_length);
-    print_separator_line(std::cout, max_line_length);
-
-    print_message(std::cout, "Options:", max_line_length);
-    print_message(std::cout, "  -e, -encode^^Encode input data to hexadecimal format (default).", max_line_length);
-    print_message(std::cout, "  -d, -decode^^Decode hexadecimal input data to binary format.", max_line_length);
-    print_message(std::cout, "  -u, -ucase^^Use uppercase hexadecimal digits (default).", max_line_length);
-    print_message(std::cout, "  -l, -lcase^^Use lowercase hexadecimal digits.", max_line_length);
-    print_message(std::cout, "  -s, -separator^^Set a single character separator between bytes.", max_line_length);
-    print_message(std::cout, "  -prefix^^^Set a prefix for each byte.", max_line_length);
-    print_message(std::cout, "  -postfix^^Set a postfix for each byte.", max_line_length);
-    print_message(std::cout, "  -header^^^Set a header for the entire output.", max_line_length);
-    print_message(std::cout, "  -footer^^^Set a footer for the entire output.", max_line_length);
-    print_message(std::cout, "  -lang, -language^Set language-specific settings.", max_line_length);
-    print_message(std::cout, "  -t, -text^^Use the following text as input.", max_line_length);
-    print_message(std::cout, "  -f, -file^^Use the following file as input.", max_line_length);
-    print_message(std::cout, "  -o, -output^^Use the following file as output.", max_line_length);
-    print_message(std::cout, "  -c, -columns^^Set the maximum number of columns per line.", max_line_length);
-    print_message(std::cout, "  -i, -input^^Enable interactive input mode.", max_line_length);
-    print_message(std::cout, "  -h, -help^^Display this help message.", max_line_length);
-    print_separator_line(std::cout, max_line_length);
-
-    print_message(std::cout, "Language-specific settings:", max_line_length);
-    print_message(std::cout, "  c, cpp, cs, vb, py, asm, go, rs, swift, kt, java, dart, js, ts, rb, php, lua", max_line_length);
-    print_separator_line(std::cout, max_line_length);
-
-    print_message(std::cout, "Examples:", max_line_length);
-    print_message(std::cout, program_name + " -e -u -s ' ' -prefix '0x' -postfix ',' -header 'const unsigned char data[] = {' -footer '};' -t 'Hello World'", max_line_length);
-    print_message(std::cout, program_name + " -d -l -f input.txt -o output.bin", max_line_length);
-    print_message(std::cout, program_name + " -e -lang cpp -t 'Hello World' -o output.cpp", max_line_length);
-    print_separator_line(std::cout, max_line_length);
+    std::ostream& console = *session->console;
+    print_message(console, program_name + " ver. " + VERSION, max_line_length);
+    print_message(console, "Copyright (C) 2024 Pavel_Bashkardin", max_line_length);
+    print_message(console, "Description:", max_line_length);
+    print_message(console, "The BASE16 program is a command-line utility for encoding and decoding data in hex (hexadecimal) format. It supports various parameters and keys for configuring the encoding and decoding process, as well as formatting the output in different programming languages.", max_line_length);
+    print_separator_line(console, max_line_length);
+
+    print_message(console, "Usage:", max_line_length);
+    print_message(console, program_name + " [-e|-encode|-d|-decode] [-u|-ucase|-l|-lcase] [-s|-separator_separator] [-prefix_prefix] [-postfix_postfix] [-header_header] [-footer_footer] [-lang|-language_language] [-t|-text_text|-f|-file_file|-o|-output_output|-c|-columns_columns|-i|-input] [-h|-help]", max_line_length);
+    print_separator_line(console, max_line_length);
+
+    print_message(console, "Options:", max_line_length);
+    print_message(console, "  -e, -encode^^Encode input data to hexadecimal format (default).", max_line_length);
+    print_message(console, "  -d, -decode^^Decode hexadecimal input data to binary format.", max_line_length);
+    print_message(console, "  -u, -ucase^^Use uppercase hexadecimal digits (default).", max_line_length);
+    print_message(console, "  -l, -lcase^^Use lowercase hexadecimal digits.", max_line_length);
+    print_message(console, "  -s, -separator^^Set a single character separator between bytes.", max_line_length);
+    print_message(console, "  -prefix^^^Set a prefix for each byte.", max_line_length);
+    print_message(console, "  -postfix^^Set a postfix for each byte.", max_line_length);
+    print_message(console, "  -header^^^Set a header for the entire output.", max_line_length);
+    print_message(console, "  -footer^^^Set a footer for the entire output.", max_line_length);
+    print_message(console, "  -lang, -language^Set language-specific settings.", max_line_length);
+    print_message(console, "  -t, -text^^Use the following text as input.", max_line_length);
+    print_message(console, "  -f, -file^^Use the following file, directory or file mask as input. Can be repeated, file names can also be given without a key.", max_line_length);
+    print_message(console, "  -o, -output^^Use the following file as output.", max_line_length);
+    print_message(console, "  -flush^^^Write the output at every line break (line), after every converted block (block) or only when the buffer is full (none). Default: line for a terminal, block otherwise.", max_line_length);
+    print_message(console, "  -errors^^^Handle invalid characters when decoding: stop at the first one (strict, default), drop them (skip) or decode them as zero digits (replace).", max_line_length);
+    print_message(console, "  -digest^^^Write a crc32c or xxh64 checksum of the bytes as a comment line after the footer, computed while encoding. When decoding, require the trailer and check it; a trailer at the end of a file is checked without this option.", max_line_length);
+    print_message(console, "  -stats^^^Print input and output sizes, wall time, MB/s, time spent reading, converting and writing, peak memory and the kernel to the standard error as text (default) or json.", max_line_length);
+    print_message(console, "  -progress^^Print a progress line to the standard error every given number of seconds.", max_line_length);
+    print_message(console, "  -io^^^^Read input files mapped into memory (mmap), on a reader thread overlapping the conversion (pipeline), or choose by file system (auto, default: network files use the pipeline).", max_line_length);
+    print_message(console, "  -mem^^^Keep the buffers of the conversion within the given number of bytes (at least 4K), suffixes as for -offset. The input is read in small blocks on one thread, nothing grows with its size.", max_line_length);
+    print_message(console, "  -od, -outdir^^Convert every input file into its own file in the following directory.", max_line_length);
+    print_message(console, "  -resources^^Compile the input files into C sources in the -od directory, one per file, and the following index header declaring their arrays, names and sizes. A manifest of content hashes and options skips files whose source is up to date.", max_line_length);
+    print_message(console, "  -c, -columns^^Set the maximum number of columns per line.", max_line_length);
+    print_message(console, "  -records^^Convert every line (lines), zero-terminated string (nul) or record with a 4-byte little-endian size in front (len32) on its own, with its own header and footer. Every record gives one output record delimited the same way.", max_line_length);
+    print_message(console, "  -offset^^^Convert the input from the given byte on, suffixes K, M, G and T multiply by 1024. When decoding, the offset counts decoded bytes and the lines holding it are found without reading the text before them.", max_line_length);
+    print_message(console, "  -length^^^Convert at most the given number of bytes, suffixes as for -offset.", max_line_length);
+    print_message(console, "  -g^^^^Set the number of bytes per digit group of a dump (default: 2, 0 for a single group).", max_line_length);
+    print_message(console, "  -i, -input^^Enable interactive input mode.", max_line_length);
+    print_message(console, "  -j^^^^Process the input on the specified number of threads (0: one per CPU core, the default for multiple input files).", max_line_length);
+    print_message(console, "  -kernel^^^Force the conversion kernel: scalar, sse2, avx2 or avx512 (default: best supported by the CPU).", max_line_length);
+    print_message(console, "  -codec^^^Write and read the bytes as " + codec_names() + " (default: base16). The other codecs wrap lines at 76 characters unless -c is given, which then counts characters, and language presets hold the text in string literals.", max_line_length);
+    print_message(console, "  -serve^^^Run as a server on the following Unix socket, converting the requests of -client on the number of threads given with -j (default: one per CPU core). Must be the first option.", max_line_length);
+    print_message(console, "  -client^^^Run the following options on the server listening on the given Unix socket, as if they ran in this process. Must be the first option.", max_line_length);
+    print_message(console, "  -h, -help^^Display this help message.", max_line_length);
+    print_separator_line(console, max_line_length);
+
+    print_message(console, "Language-specific settings:", max_line_length);
+    print_message(console, "  c, cpp, cs, vb, py, asm, go, rs, swift, kt, java, dart, js, ts, rb, php, lua", max_line_length);
+    print_message(console, "  cstr^^^C string literals with \\x escapes, compiled much faster than an array of numbers.", max_line_length);
+    print_message(console, "  u64^^^^C array of little-endian 64-bit numbers, eight bytes per token (-c counts numbers).", max_line_length);
+    print_message(console, "  embed, incbin^^C23 #embed or assembler .incbin of the input file, only its size is read. Cannot be decoded.", max_line_length);
+    print_message(console, "  xxd^^^^Dump with offsets, grouped lowercase digits and printable characters like xxd (16 bytes per line unless -c is given), decoded back with -d.", max_line_length);
+    print_separator_line(console, max_line_length);
+
+    print_message(console, "Examples:", max_line_length);
+    print_message(console, program_name + " -e -u -s ' ' -prefix '0x' -postfix ',' -header 'const unsigned char data[] = {' -footer '};' -t 'Hello World'", max_line_length);
+    print_message(console, program_name + " -d -l -f input.txt -o output.bin", max_line_length);
+    print_message(console, program_name + " -e -lang cpp -t 'Hello World' -o output.cpp", max_line_length);
+    print_separator_line(console, max_line_length);
 }
 
 // Function to get the width of the console
@@ -169,301 +637,2640 @@ int calculate_max_columns(int max_chars, const std::string& prefix, const std::s
     return max_columns;
 }
 
-// Function to encode input data to hexadecimal format
-void encode(std::istream& input, std::ostream& output, const Parameters& params) {
-    char byte;
-    int column_count = 0;
-    bool is_last_byte = false;
+// Pool of worker threads running tasks in submission order, every task in the session that submitted it
+class WorkerPool {
+public:
+    explicit WorkerPool(int threads) {
+        for (int i = 0; i < threads; ++i) {
+            workers.emplace_back([this] { run(); });
+        }
+    }
 
-    // Read each byte from the input stream
-    while (input.get(byte)) {
-        is_last_byte = input.peek() == EOF;
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
 
-        // Output the byte in hexadecimal format with the specified prefix, postfix, and separator
-        output << params.prefix << std::hex << std::setw(HEX_BYTE_LENGTH) << std::setfill('0') << (params.upper_case ? std::uppercase : std::nouppercase) << static_cast<int>(static_cast<unsigned char>(byte));
+    // Function to queue a task, its result is delivered through the returned future
+    template <typename Task>
+    std::future<typename std::invoke_result<Task>::type> submit(Task task) {
+        auto packaged = std::make_shared<std::packaged_task<typename std::invoke_result<Task>::type()>>(std::move(task));
+        auto result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push([packaged, owner = session] {
+                session = owner;
+                (*packaged)();
+            });
+        }
+        ready.notify_one();
+        return result;
+    }
 
-        // Add postfix and separator if not the last byte and not the last column
-        if (!is_last_byte || !params.suppress_last_postfix) {
-            if (params.separator && column_count < params.max_columns - 1) {
-                output << params.postfix << params.separator;
+private:
+    void run() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop();
             }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable ready;
+    bool stopping = false;
+};
+
+// Structure to hold a chunk of input data for parallel processing
+struct InputChunk {
+    const char* data; // First byte of the chunk
+    size_t size; // Size of the chunk in bytes
+    bool is_final; // Flag to indicate the last chunk of the input
+    std::vector<char> storage; // Chunk data read from a stream, empty for mapped input
+};
+
+// Function to take the next chunk of mapped input, returns false at the end of the input
+bool next_chunk(const MappedFile& input, size_t& offset, size_t chunk_size, InputChunk& chunk) {
+    if (offset >= input.size) {
+        return false;
+    }
+    chunk.data = input.data + offset;
+    chunk.size = std::min(chunk_size, input.size - offset);
+    offset += chunk.size;
+    chunk.is_final = offset == input.size;
+    return true;
+}
+
+// Function to read the next chunk of stream input, returns false at the end of the input
+bool next_chunk(std::istream& input, size_t& offset, size_t chunk_size, InputChunk& chunk) {
+    StageTimer timer(Stage::Read);
+    chunk.storage.resize(chunk_size);
+    input.read(chunk.storage.data(), chunk_size);
+    chunk.size = input.gcount();
+    if (chunk.size == 0) {
+        return false;
+    }
+    chunk.data = chunk.storage.data();
+    chunk.is_final = chunk.size < chunk_size || input.peek() == EOF;
+    offset += chunk.size;
+    return true;
+}
+
+// Function to extend a chunk of mapped input to the end of its last line, the next chunk starts on a new line
+void extend_to_line_end(const MappedFile& input, size_t& offset, InputChunk& chunk) {
+    if (chunk.is_final || chunk.data[chunk.size - 1] == '\n') {
+        return;
+    }
+    const char* line_end = static_cast<const char*>(memchr(input.data + offset, '\n', input.size - offset));
+    size_t length = line_end ? line_end + 1 - (input.data + offset) : input.size - offset;
+    chunk.size += length;
+    offset += length;
+    chunk.is_final = offset == input.size;
+}
+
+// Function to extend a chunk of stream input to the end of its last line, the next chunk starts on a new line
+void extend_to_line_end(std::istream& input, size_t& offset, InputChunk& chunk) {
+    if (chunk.is_final || chunk.data[chunk.size - 1] == '\n') {
+        return;
+    }
+    StageTimer timer(Stage::Read);
+    std::string line;
+    std::getline(input, line);
+    if (!input.eof()) {
+        line += '\n';
+    }
+    chunk.storage.resize(chunk.size);
+    chunk.storage.insert(chunk.storage.end(), line.begin(), line.end());
+    chunk.data = chunk.storage.data();
+    chunk.size = chunk.storage.size();
+    chunk.is_final = input.peek() == EOF;
+    offset += line.length();
+}
+
+// Function to calculate the size of parallel chunks, encoded chunks always start on a new line
+size_t parallel_chunk_size(const Parameters& params) {
+    const size_t group_bytes = params.encode_mode ? params.codec->group_bytes : 1;
+    size_t size = PARALLEL_CHUNK_SIZE / group_bytes * group_bytes;
+    if (params.encode_mode && params.max_columns > 0) {
+        // Dump lines hold max_columns bytes as well and their offsets continue from the previous chunk,
+        // lines of a word format hold max_columns numbers, group_bytes lines of a codec hold whole groups
+        const size_t line_size = params.max_columns * static_cast<size_t>(std::max(1, params.word_size)) * group_bytes;
+        size = std::max<size_t>(1, size / line_size) * line_size;
+    }
+    return size;
+}
+
+// Structure to hold the result of encoding one chunk
+struct EncodedChunk {
+    std::vector<char> text; // Encoded characters
+    long long column_count; // Number of bytes written to the last line
+};
+
+// Function to encode input data on a pool of worker threads and write the chunks in order.
+// The digest is taken over the chunks in order while they are written.
+template <typename Input>
+Digest encode_parallel(Input& input, std::ostream& output, const Parameters& params) {
+    WorkerPool pool(params.threads);
+    std::deque<std::pair<std::shared_ptr<InputChunk>, std::future<EncodedChunk>>> pending;
+    const Format format = compile_format(params);
+    const size_t chunk_size = parallel_chunk_size(params);
+    size_t offset = 0;
+    long long column_count = 0;
+    Digest digest(params.digest);
+
+    auto write_next = [&] {
+        std::shared_ptr<InputChunk> chunk = pending.front().first;
+        EncodedChunk result = pending.front().second.get();
+        pending.pop_front();
+        digest.update(std::span<const unsigned char>(reinterpret_cast<const unsigned char*>(chunk->data), chunk->size));
+        output.write(result.text.data(), result.text.size());
+        column_count = result.column_count;
+    };
+
+    while (true) {
+        auto chunk = std::make_shared<InputChunk>();
+        if (!next_chunk(input, offset, chunk_size, *chunk)) {
+            break;
         }
+        bool is_final = chunk->is_final;
 
-        column_count++;
+        // Every chunk holds whole lines, so it is encoded from the first column
+        size_t start = offset - chunk->size;
+        pending.emplace_back(chunk, pool.submit([chunk, start, &format, &params] {
+            StageTimer timer(Stage::Transform, chunk->size);
+            EncodedChunk result;
+            EncoderState state;
+            state.offset = start;
+            result.text.resize(encoded_block_bound(chunk->size, params));
+            result.text.resize(encode_block(reinterpret_cast<const unsigned char*>(chunk->data), chunk->size, chunk->is_final, state, format, result.text.data()));
+            result.column_count = state.column_count;
+            return result;
+        }));
 
-        // Add a newline if the maximum number of columns is reached
-        if (params.max_columns > 0 && column_count == params.max_columns && !is_last_byte) {
-            output << std::endl;
-            column_count = 0;
+        if (pending.size() >= static_cast<size_t>(params.threads) * 2) {
+            write_next();
         }
+        if (is_final) {
+            break;
+        }
+    }
+    while (!pending.empty()) {
+        write_next();
     }
 
     // Add a newline if there are remaining columns
     if (column_count != 0) {
         output << std::endl;
     }
+    return digest;
 }
 
-// Function to decode hexadecimal input data to binary format
-void decode(std::istream& input, std::ostream& output, const Parameters& params) {
-    std::string hex_string;
-    char ch;
-    bool use_separator = params.separator != '\0';
+// Structure to describe an input file read by the pipeline
+struct InputFile {
+    int fd; // Open file descriptor
+    bool seekable; // Flag to indicate a regular file read with pread at explicit offsets
+    std::string name; // File name for error messages
+    long long start = 0; // First byte read
+    long long end = LLONG_MAX; // End of the bytes read
+};
+
+// Function to open an input file for the pipeline, returns false on failure
+bool open_input_file(const std::string& file_name, InputFile& input) {
+#ifdef _WIN32
+    input.fd = _open(session_path(file_name).c_str(), _O_RDONLY | _O_BINARY);
+    input.seekable = false;
+#else
+    input.fd = open(session_path(file_name).c_str(), O_RDONLY);
+    struct stat st;
+    input.seekable = input.fd >= 0 && fstat(input.fd, &st) == 0 && S_ISREG(st.st_mode);
+#endif
+    input.name = file_name;
+    return input.fd >= 0;
+}
+
+// Function to close an input file opened with open_input_file
+void close_input_file(InputFile& input) {
+#ifdef _WIN32
+    _close(input.fd);
+#else
+    close(input.fd);
+#endif
+}
+
+// Buffer passed between the pipeline stages
+struct PipelineBlock {
+    std::vector<char> data; // Buffer of a fixed capacity
+    size_t size = 0; // Number of bytes used
+    bool is_final = false; // Flag to indicate the last block of the input
+};
+
+// Bounded queue passing buffers from one pipeline stage to the next. Closing the queue wakes up
+// both sides: push fails from then on, pop returns the remaining items and then fails.
+class StageQueue {
+public:
+    explicit StageQueue(size_t capacity) : capacity(capacity) {
+    }
+
+    bool push(PipelineBlock block) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this] { return closed || items.size() < capacity; });
+        if (closed) {
+            return false;
+        }
+        items.push_back(std::move(block));
+        not_empty.notify_one();
+        return true;
+    }
+
+    bool pop(PipelineBlock& block) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this] { return closed || !items.empty(); });
+        if (items.empty()) {
+            return false;
+        }
+        block = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
+
+private:
+    size_t capacity;
+    std::deque<PipelineBlock> items;
+    std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+    bool closed = false;
+};
 
-    // Read each character from the input stream
-    while (input.get(ch)) {
-        if (isspace(ch)) {
-            continue; // Ignore spaces
+// Function to fill a block from the input file, returns false on read errors
+bool read_block(const InputFile& input, long long& offset, PipelineBlock& block) {
+    StageTimer timer(Stage::Read);
+    block.size = 0;
+
+    // Files that cannot be read at an offset are read and dropped up to the first byte
+    while (offset < input.start) {
+        size_t size = static_cast<size_t>(std::min<long long>(block.data.size(), input.start - offset));
+#ifdef _WIN32
+        int length = _read(input.fd, block.data.data(), static_cast<unsigned int>(size));
+#else
+        ssize_t length = read(input.fd, block.data.data(), size);
+        if (length < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (length <= 0) {
+            return length == 0;
+        }
+        offset += length;
+    }
+
+    const size_t capacity = static_cast<size_t>(std::min<long long>(block.data.size(), input.end - offset));
+    while (block.size < capacity) {
+        char* buffer = block.data.data() + block.size;
+        size_t size = capacity - block.size;
+#ifdef _WIN32
+        int length = _read(input.fd, buffer, static_cast<unsigned int>(size));
+#else
+        ssize_t length = input.seekable ? pread(input.fd, buffer, size, offset) : read(input.fd, buffer, size);
+        if (length < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (length < 0) {
+            return false;
         }
-        if (use_separator && ch == params.separator) {
-            continue; // Ignore separator
+        if (length == 0) {
+            break;
+        }
+        block.size += length;
+        offset += length;
+    }
+    return true;
+}
+
+// Function to convert an input file in three overlapping stages: a reader thread fills a ring of input
+// buffers, the calling thread converts them with the transform and a writer thread drains the results.
+// The transform returns false to stop the conversion early; the blocks converted so far are still written.
+template <typename Transform>
+void run_pipeline(const InputFile& input, std::ostream& output, size_t output_block_size, Transform transform) {
+    StageQueue free_inputs(PIPELINE_DEPTH), filled(PIPELINE_DEPTH), free_outputs(PIPELINE_DEPTH), converted(PIPELINE_DEPTH);
+    for (size_t i = 0; i < PIPELINE_DEPTH; ++i) {
+        free_inputs.push(PipelineBlock{ std::vector<char>(PIPELINE_BLOCK_SIZE) });
+        free_outputs.push(PipelineBlock{ std::vector<char>(output_block_size) });
+    }
+    bool read_failed = false;
+
+    // The reader looks one block ahead to flag the final block of the input
+    std::thread reader([&, owner = session] {
+        session = owner;
+        long long offset = input.seekable ? input.start : 0;
+        auto take = [&](PipelineBlock& block) {
+            if (!free_inputs.pop(block)) {
+                return false;
+            }
+            read_failed = !read_block(input, offset, block);
+            return !read_failed;
+        };
+
+        PipelineBlock current;
+        PipelineBlock next;
+        if (take(current)) {
+            while (current.size > 0 && take(next)) {
+                current.is_final = next.size == 0;
+                if (!filled.push(std::move(current))) {
+                    break;
+                }
+                current = std::move(next);
+            }
         }
-        if (!isxdigit(ch)) {
-            print_message(std::cerr, "Invalid character: " + std::string(1, ch), params.max_chars);
-            exit(1);
+        filled.close();
+    });
+
+    std::thread writer([&, owner = session] {
+        session = owner;
+        PipelineBlock block;
+        while (converted.pop(block)) {
+            output.write(block.data.data(), block.size);
+            free_outputs.push(std::move(block));
         }
+    });
 
-        // Accumulate hexadecimal digits
-        hex_string += static_cast<char>(tolower(ch));
+    // Function to stop the reader, let the writer drain the converted blocks and wait for both
+    auto finish = [&] {
+        free_inputs.close();
+        filled.close();
+        converted.close();
+        reader.join();
+        writer.join();
+    };
 
-        // Convert to byte when two hexadecimal digits are accumulated
-        if (hex_string.size() == HEX_BYTE_LENGTH) {
-            unsigned int byte;
-            std::stringstream hex_ss;
-            hex_ss << std::hex << hex_string;
-            hex_ss >> byte;
-            output << static_cast<char>(byte);
-            hex_string.clear();
+    try {
+        PipelineBlock block;
+        PipelineBlock result;
+        while (filled.pop(block) && free_outputs.pop(result)) {
+            StageTimer timer(Stage::Transform, block.size);
+            bool proceed = transform(block, result);
+            timer.stop();
+            converted.push(std::move(result));
+            free_inputs.push(std::move(block));
+            if (!proceed) {
+                break;
+            }
         }
+    } catch (...) {
+        finish();
+        throw;
     }
+    finish();
 
-    // Check for incomplete hexadecimal byte
-    if (!hex_string.empty()) {
-        print_message(std::cerr, "Incomplete hexadecimal byte: " + hex_string, params.max_chars);
-        exit(1);
+    if (read_failed) {
+        throw std::runtime_error("Failed to read file: " + input.name);
     }
 }
 
-// Function to handle input and determine whether to encode or decode
-void handle_input(std::istream& input, std::ostream& output, const Parameters& params) {
-    if (!params.header.empty()) {
-        output << params.header;// << std::endl;
+// Function to encode mapped input data to hexadecimal format, the kernels read the mapped pages directly.
+// Returns the digest of the input, taken from every block while it is in the cache.
+Digest encode(const MappedFile& input, std::ostream& output, const Parameters& params) {
+    if (params.threads > 1) {
+        return encode_parallel(input, output, params);
     }
 
-    // Determine whether to encode or decode based on the encode_mode flag
-    if (params.encode_mode) {
-        encode(input, output, params);
-    } else {
-        decode(input, output, params);
+    std::vector<char> output_buffer(encoded_block_bound(params.block_size, params));
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(input.data);
+    const Format format = compile_format(params);
+    EncoderState state;
+    Digest digest(params.digest);
+
+    for (size_t offset = 0; offset < input.size; offset += params.block_size) {
+        size_t size = std::min(params.block_size, input.size - offset);
+        StageTimer timer(Stage::Transform, size);
+        size_t length = encode_block(data + offset, size, offset + size == input.size, state, format, output_buffer.data());
+        digest.update(std::span<const unsigned char>(data + offset, size));
+        timer.stop();
+        output.write(output_buffer.data(), length);
     }
 
-    if (!params.footer.empty()) {
-        output << params.footer;
+    // Add a newline if there are remaining columns
+    if (state.column_count != 0) {
+        output << std::endl;
     }
-    
-    output << std::endl;
+    return digest;
 }
 
-// Signal handler for interactive mode
-void signal_handler(int signum) {
-    std::cout << std::endl;
-    exit(signum);
-}
-
-// Function to set language-specific settings
-void set_language_settings(const std::string& lang, Parameters& params) {
-    if (lang == "c") {
-        // Settings for C language
-        params.separator = ' ';
-        params.prefix = "0x";
-        params.postfix = ",";
-        params.header = STRLINE("const unsigned char data[] = {");
-        params.footer = STRLINE("};");
-        params.suppress_last_postfix = true;
-        params.file_extension = ".c";
-    } else if (lang == "cpp") {
-        // Settings for C++ language
-        params.separator = ' ';
-        params.prefix = "0x";
-        params.postfix = ",";
-        params.header = STRLINE("const std::vector<unsigned char> data = {");
-        params.footer = STRLINE("};");
-        params.suppress_last_postfix = true;
-        params.file_extension = ".cpp";
-    } else if (lang == "cs") {
-        // Settings for C# language
-        params.separator = ' ';
-        params.prefix = "0x";
-        params.postfix = ",";
-        params.header = STRLINE("byte[] data = new byte[] {");
-        params.footer = STRLINE("};");
-        params.suppress_last_postfix = true;
-        params.file_extension = ".cs";
-    } else if (lang == "vb") {
-        // Settings for Visual Basic language
-        params.separator = ' ';
-        params.prefix = "&H";
-        params.postfix = ",";
-        params.header = STRLINE("Dim data As Byte() = {");
-        params.footer = STRLINE("}");
-        params.suppress_last_postfix = true;
-        params.file_extension = ".vb";
-    } else if (lang == "py") {
-        // Settings for Python language
-        params.separator = ' ';
-        params.prefix = "0x";
-        params.postfix = ",";
-        params.header = STRLINE("data = bytes([");
-        params.footer = STRLINE("])");
-        params.suppress_last_postfix = true;
-        params.file_extension = ".py";
-    } else if (lang == "asm") {
-        // Settings for Assembly language
-        params.separator = ' ';
-        params.prefix = "0x";
-        params.postfix = ",";
-        params.header = STRLINE("data db ");
-        params.footer = "";
-        params.suppress_last_postfix = true;
-        params.file_extension = ".asm";
-    } else if (lang == "go") {
-        // Settings for Go language
-        params.separator = ' ';
-        params.prefix = "0x";
-        params.postfix = ",";
-        params.header = STRLINE("var data = []byte{");
-        params.footer = STRLINE("}");
-        params.suppress_last_postfix = true;
-        params.file_extension = ".go";
-    } else if (lang == "rs") {
-        // Settings for Rust language
-        params.separator = ' ';
-        params.prefix = "0x";
-        params.postfix = ",";
-        params.header = STRLINE("let data: [u8; N] = [");
-        params.footer = STRLINE("];");
-        params.suppress_last_postfix = true;
-        params.file_extension = ".rs";
-    } else if (lang == "swift") {
-        // Settings for Swift language
-        params.separator = ' ';
-        params.prefix = "0x";
-        params.postfix = ",";
-        params.header = STRLINE("let data: [UInt8] = [");
-        params.footer = STRLINE("]");
-        params.suppress_last_postfix = true;
-        params.file_extension = ".swift";
-    } else if (lang == "kt") {
-        // Settings for Kotlin language
-        params.separator = ' ';
-        params.prefix = "0x";
-        params.postfix = ",";
-        params.header = STRLINE("val data = byteArrayOf(");
-        params.footer = STRLINE(")");
-        params.suppress_last_postfix = true;
-        params.file_extension = ".kt";
-    } else if (lang == "java") {
-        // Settings for Java language
-        params.separator = ' ';
-        params.prefix = "0x";
-        params.postfix = ",";
-        params.header = STRLINE("byte[] data = new byte[] {");
-        params.footer = STRLINE("};");
-        params.suppress_last_postfix = true;
-        params.file_extension = ".java";
-    } else if (lang == "dart") {
-        // Settings for Dart language
-        params.separator = ' ';
-        params.prefix = "0x";
-        params.postfix = ",";
-        params.header = STRLINE("List<int> data = [");
-        params.footer = STRLINE("];");
-        params.suppress_last_postfix = true;
-        params.file_extension = ".dart";
-    } else if (lang == "js") {
-        // Settings for JavaScript language
-        params.separator = ' ';
-        params.prefix = "0x";
-        params.postfix = ",";
-        params.header = STRLINE("const data = [");
-        params.footer = STRLINE("];");
-        params.suppress_last_postfix = true;
-        params.file_extension = ".js";
-    } else if (lang == "ts") {
-        // Settings for TypeScript language
-        params.separator = ' ';
-        params.prefix = "0x";
-        params.postfix = ",";
-        params.header = STRLINE("const data: number[] = [");
-        params.footer = STRLINE("];");
-        params.suppress_last_postfix = true;
-        params.file_extension = ".ts";
-    } else if (lang == "rb") {
-        // Settings for Ruby language
-        params.separator = ' ';
-        params.prefix = "0x";
-        params.postfix = ",";
-        params.header = STRLINE("data = [");
-        params.footer = STRLINE("]");
-        params.suppress_last_postfix = true;
-        params.file_extension = ".rb";
-    } else if (lang == "php") {
-        // Settings for PHP language
-        params.separator = ' ';
-        params.prefix = "0x";
-        params.postfix = ",";
-        params.header = STRLINE("$data = [");
-        params.footer = STRLINE("];");
-        params.suppress_last_postfix = true;
-        params.file_extension = ".php";
-    } else if (lang == "lua") {
-        // Settings for Lua language
-        params.separator = ' ';
-        params.prefix = "0x";
-        params.postfix = ",";
-        params.header = STRLINE("local data = {");
-        params.footer = STRLINE("}");
-        params.suppress_last_postfix = true;
-        params.file_extension = ".lua";
-    } else if (lang == "url") {
-        // Settings for URL format
-        params.separator = '\0'; // No separator
-        params.prefix = "%"; // URL encoding prefix
-        params.postfix = ""; // No postfix
-        params.header = "http://";
-        params.footer = "";
-        params.suppress_last_postfix = false;
-        params.file_extension = "";
-        params.max_columns = 0;
-    } else if (lang == "bat") {
-        // Settings for BAT format
-        params.separator = ' '; // No separator
-        params.prefix = ""; // URL encoding prefix
-        params.postfix = ""; // No postfix
-        params.header = 
-            STRLINE(":BEGIN\n") +
-            STRLINE("@ECHO OFF") +
-            STRLINE("SET /P filename=\"Enter filename: \"") +
-            STRLINE("SET tmpfile=%~d0%~p0%RANDOM%.tmp") +
-            STRLINE("SET outfile=%~d0%~p0%filename%") +
-            STRLINE("ECHO tmpfile = %tmpfile%") +
-            STRLINE("ECHO outfile = %outfile%") +
-            STRLINE("FINDSTR \"^[0-9A-F][0-9A-F][^\\s]\" %0 > \"%tmpfile%\"") +
-            STRLINE("certutil -decodehex \"%tmpfile%\" \"%outfile%\"") +
-            STRLINE("TIMEOUT 3") +
-            STRLINE("DEL /F /Q \"%tmpfile%\" %0") +
-            STRLINE("EXIT") + NEWLINE;
-        params.footer = "";
-        params.suppress_last_postfix = false;
-        params.file_extension = ".bat";
-    } else {
-        print_message(std::cerr, "Unknown language: " + lang, params.max_chars);
-        exit(1);
+// Function to encode input data to hexadecimal format, returns the digest of the input
+Digest encode(std::istream& input, std::ostream& output, const Parameters& params) {
+    if (params.threads > 1) {
+        return encode_parallel(input, output, params);
+    }
+
+    std::vector<char> input_buffer(params.block_size);
+    std::vector<char> output_buffer(encoded_block_bound(params.block_size, params));
+    const Format format = compile_format(params);
+    EncoderState state;
+    Digest digest(params.digest);
+
+    // Read the input stream block by block
+    while (true) {
+        StageTimer read_timer(Stage::Read);
+        input.read(input_buffer.data(), input_buffer.size());
+        size_t size = input.gcount();
+        if (size == 0) {
+            break;
+        }
+        bool is_final = size < input_buffer.size() || input.peek() == EOF;
+        read_timer.stop();
+
+        StageTimer timer(Stage::Transform, size);
+        size_t length = encode_block(reinterpret_cast<const unsigned char*>(input_buffer.data()), size, is_final, state, format, output_buffer.data());
+        digest.update(std::span<const unsigned char>(reinterpret_cast<const unsigned char*>(input_buffer.data()), size));
+        timer.stop();
+        output.write(output_buffer.data(), length);
+        if (is_final) {
+            break;
+        }
+    }
+
+    // Add a newline if there are remaining columns
+    if (state.column_count != 0) {
+        output << std::endl;
     }
+    return digest;
 }
 
+// Function to format a position in the input for messages
+std::string format_position(const TextPosition& position) {
+    return "line " + std::to_string(position.line) + ", column " + std::to_string(position.column) + " (offset " + std::to_string(position.offset) + ")";
+}
 
-int main(int argc, char* argv[]) {
+// Function to translate a position relative to the start of a chunk into a position in the whole input
+TextPosition offset_position(const TextPosition& start, const TextPosition& relative) {
+    TextPosition position = relative;
+    position.offset += start.offset;
+    position.line += start.line - 1;
+    if (relative.line == 1) {
+        position.column += start.column - 1;
+    }
+    return position;
+}
+
+// Function to report an invalid character
+Status report_invalid_character(char ch, const TextPosition& position, const Parameters& params) {
+    print_message(*session->errors, "Invalid character: " + std::string(1, ch) + " at " + format_position(position), params.max_chars);
+    return Status::InvalidCharacter;
+}
+
+// Function to check whether only a range of the bytes is converted
+bool has_range(const Parameters& params) {
+    return params.range_offset > 0 || params.range_length != WHOLE_INPUT;
+}
+
+// Function to describe the incomplete hexadecimal byte or group of a codec at the end of the input by its last digit
+std::string incomplete_message(char digit, const Parameters& params) {
+    if (params.codec->encode_groups != nullptr) {
+        return "Incomplete " + std::string(params.codec->name) + " group: " + digit;
+    }
+    return "Incomplete hexadecimal byte: " + std::string(1, static_cast<char>(tolower(digit)));
+}
+
+// Function to check the end of the decoded input: an incomplete hexadecimal byte in strict mode and the digest trailer,
+// otherwise the number of invalid characters skipped or replaced is reported
+Status check_complete(Status status, const DecoderState& state, const Digest& digest, const Parameters& params) {
+    if (status == Status::IncompleteByte) {
+        print_message(*session->errors, incomplete_message(state.pending_digits.back(), params), params.max_chars);
+        return status;
+    }
+    if (status == Status::MissingDigest) {
+        print_message(*session->errors, "Missing digest: no " + std::string(digest_name(digest.type())) + " trailer after the data", params.max_chars);
+        return status;
+    }
+    if (status == Status::DigestMismatch) {
+        std::ostringstream value;
+        value << std::hex << std::uppercase << std::setfill('0') << std::setw(digest.type() == DigestType::Crc32c ? 8 : 16) << digest.value();
+        print_message(*session->errors, "Digest mismatch: " + std::string(digest_name(digest.type())) + " of the decoded data is " + value.str() + ", the trailer has " + state.digest_line, params.max_chars);
+        return status;
+    }
+    if (!state.digest_line.empty() && digest.type() == DigestType::None && !has_range(params)) {
+        print_message(*session->errors, "Warning: digest trailer not verified, decode with -digest to check it: " + state.digest_line, params.max_chars);
+    }
+    if (state.error_count > 0) {
+        std::string action = params.errors == ErrorMode::Skip ? "Skipped " : "Replaced ";
+        print_message(*session->errors, action + std::to_string(state.error_count) + " invalid characters, the first at " + format_position(state.first_error), params.max_chars);
+    }
+    return Status::Ok;
+}
+
+// Structure to hold the result of decoding one chunk
+struct DecodedChunk {
+    std::vector<unsigned char> bytes; // Decoded bytes
+    size_t consumed; // Number of characters decoded before an invalid character
+    DecoderState state; // State of the decoder at the end of the chunk
+};
+
+// Function to decode a chunk starting from the given decoder state
+DecodedChunk decode_chunk(const InputChunk& chunk, DecoderState state, const DecodeFormat& format) {
+    DecodedChunk result;
+    std::vector<char> digits;
+    result.bytes.resize(max_decoded_size(chunk.size, format.codec));
+    result.bytes.resize(decode_block(chunk.data, chunk.size, state, format, digits, result.bytes.data(), result.consumed));
+    result.state = std::move(state);
+    return result;
+}
+
+// Function to decode input data on a pool of worker threads and write the chunks in order.
+// Chunks after the first are decoded assuming they start on a byte boundary in the body; a chunk
+// that follows an incomplete byte, the header or the footer is decoded again with the carried state.
+template <typename Input>
+Status decode_parallel(Input& input, std::ostream& output, const Parameters& params) {
+    WorkerPool pool(params.threads);
+    std::deque<std::pair<std::shared_ptr<InputChunk>, std::future<DecodedChunk>>> pending;
+    const size_t chunk_size = parallel_chunk_size(params);
+    size_t offset = 0;
+    DecodeFormat format = compile_decode_format(params);
+    DecoderState state;
+    DecoderState boundary_state;
+    boundary_state.phase = DecoderPhase::Body;
+    boundary_state.is_empty = false; // Bytes were decoded before the chunk
+    size_t written_chunks = 0;
+    Digest digest(params.digest);
+
+    auto write_next = [&] {
+        std::shared_ptr<InputChunk> chunk = pending.front().first;
+        DecodedChunk result = pending.front().second.get();
+        pending.pop_front();
+        if (written_chunks++ > 0 && !state.is_byte_boundary()) {
+            StageTimer timer(Stage::Transform);
+            result = decode_chunk(*chunk, state, format);
+        } else {
+            // Positions in a chunk decoded on its own are relative to the start of the chunk
+            result.state.first_error = state.error_count > 0 ? state.first_error : offset_position(state.position, result.state.first_error);
+            result.state.error_count += state.error_count;
+            result.state.position = offset_position(state.position, result.state.position);
+        }
+        digest.update(result.bytes);
+        output.write(reinterpret_cast<const char*>(result.bytes.data()), result.bytes.size());
+        state = std::move(result.state);
+
+        if (result.consumed < chunk->size) {
+            return report_invalid_character(chunk->data[result.consumed], state.position, params);
+        }
+        return Status::Ok;
+    };
+
+    while (true) {
+        auto chunk = std::make_shared<InputChunk>();
+        if (!next_chunk(input, offset, chunk_size, *chunk)) {
+            break;
+        }
+
+        // The language preset is detected from the first chunk, later chunks start in the body
+        bool is_first = offset == chunk->size;
+        if (is_first && params.auto_detect) {
+            Parameters detected = params;
+            const char* lang = detect_language(std::span<const char>(chunk->data, chunk->size), params.codec);
+            if (lang != nullptr) {
+                set_language_settings(lang, detected);
+                format = compile_decode_format(detected);
+            }
+        }
+
+        // Chunks of a dump end with a whole line, so the next one starts at an offset column
+        if (format.dump) {
+            extend_to_line_end(input, offset, *chunk);
+        }
+        bool is_final = chunk->is_final;
+        pending.emplace_back(chunk, pool.submit([chunk, is_first, &boundary_state, &format] {
+            StageTimer timer(Stage::Transform, chunk->size);
+            return decode_chunk(*chunk, is_first ? DecoderState() : boundary_state, format);
+        }));
+
+        if (pending.size() >= static_cast<size_t>(params.threads) * 2) {
+            Status status = write_next();
+            if (status != Status::Ok) {
+                return status;
+            }
+        }
+        if (is_final) {
+            break;
+        }
+    }
+    while (!pending.empty()) {
+        Status status = write_next();
+        if (status != Status::Ok) {
+            return status;
+        }
+    }
+
+    // The incomplete last group of a codec is decoded once the input has ended
+    unsigned char last[MAX_GROUP_SIZE];
+    size_t last_size = decode_last_group(state, format, last);
+    digest.update(std::span<const unsigned char>(last, last_size));
+    output.write(reinterpret_cast<const char*>(last), last_size);
+
+    Status status = decode_end(state, format);
+    if (status == Status::Ok) {
+        status = check_digest(state, format, digest);
+    }
+    return check_complete(status, state, digest, params);
+}
+
+// Function to decode mapped hexadecimal input data to binary format, the kernels read the mapped pages directly
+Status decode(const MappedFile& input, std::ostream& output, const Parameters& params) {
+    if (params.threads > 1) {
+        return decode_parallel(input, output, params);
+    }
+
+    std::vector<unsigned char> output_buffer(std::max(max_decoded_size(params.block_size, params.codec), MAX_GROUP_SIZE));
+    Decoder decoder(params);
+
+    for (size_t offset = 0; offset < input.size; offset += params.block_size) {
+        size_t size = std::min(params.block_size, input.size - offset);
+        StageTimer timer(Stage::Transform, size);
+        Result result = decoder.update(std::span<const char>(input.data + offset, size), output_buffer);
+        timer.stop();
+        output.write(reinterpret_cast<const char*>(output_buffer.data()), result.written);
+
+        if (result.status == Status::InvalidCharacter) {
+            return report_invalid_character(input.data[offset + result.read], decoder.current_state().position, params);
+        }
+    }
+
+    Result last = decoder.finish(output_buffer);
+    output.write(reinterpret_cast<const char*>(output_buffer.data()), last.written);
+    return check_complete(last.status, decoder.current_state(), decoder.digest(), params);
+}
+
+// Function to decode hexadecimal input data to binary format
+Status decode(std::istream& input, std::ostream& output, const Parameters& params) {
+    if (params.threads > 1) {
+        return decode_parallel(input, output, params);
+    }
+
+    std::vector<char> input_buffer(params.block_size);
+    std::vector<unsigned char> output_buffer(std::max(max_decoded_size(params.block_size, params.codec), MAX_GROUP_SIZE));
+    Decoder decoder(params);
+
+    // Read the input stream block by block
+    while (true) {
+        StageTimer read_timer(Stage::Read);
+        if (!input.read(input_buffer.data(), input_buffer.size()) && input.gcount() == 0) {
+            break;
+        }
+        size_t size = input.gcount();
+        read_timer.stop();
+
+        StageTimer timer(Stage::Transform, size);
+        Result result = decoder.update(std::span<const char>(input_buffer.data(), size), output_buffer);
+        timer.stop();
+        output.write(reinterpret_cast<const char*>(output_buffer.data()), result.written);
+
+        if (result.status == Status::InvalidCharacter) {
+            return report_invalid_character(input_buffer[result.read], decoder.current_state().position, params);
+        }
+    }
+
+    Result last = decoder.finish(output_buffer);
+    output.write(reinterpret_cast<const char*>(output_buffer.data()), last.written);
+    return check_complete(last.status, decoder.current_state(), decoder.digest(), params);
+}
+
+// Function to encode an input file to hexadecimal format with the pipeline, returns the digest of the input
+Digest encode(const InputFile& input, std::ostream& output, const Parameters& params) {
+    const Format format = compile_format(params);
+    EncoderState state;
+    Digest digest(params.digest);
+
+    run_pipeline(input, output, encoded_block_bound(PIPELINE_BLOCK_SIZE, params), [&](const PipelineBlock& block, PipelineBlock& result) {
+        std::span<const unsigned char> data(reinterpret_cast<const unsigned char*>(block.data.data()), block.size);
+        result.size = encode_block(data.data(), data.size(), block.is_final, state, format, result.data.data());
+        digest.update(data);
+        return true;
+    });
+
+    // Add a newline if there are remaining columns
+    if (state.column_count != 0) {
+        output << std::endl;
+    }
+    return digest;
+}
+
+// Function to decode a hexadecimal input file to binary format with the pipeline
+Status decode(const InputFile& input, std::ostream& output, const Parameters& params) {
+    Decoder decoder(params);
+    char invalid_character = '\0';
+    bool is_valid = true;
+
+    run_pipeline(input, output, max_decoded_size(PIPELINE_BLOCK_SIZE, params.codec), [&](const PipelineBlock& block, PipelineBlock& result) {
+        std::span<unsigned char> bytes(reinterpret_cast<unsigned char*>(result.data.data()), result.data.size());
+        Result decoded = decoder.update(std::span<const char>(block.data.data(), block.size), bytes);
+        result.size = decoded.written;
+        if (decoded.status == Status::InvalidCharacter) {
+            invalid_character = block.data[decoded.read];
+            is_valid = false;
+        }
+        return is_valid;
+    });
+
+    if (!is_valid) {
+        return report_invalid_character(invalid_character, decoder.current_state().position, params);
+    }
+    unsigned char last_group[MAX_GROUP_SIZE];
+    Result last = decoder.finish(last_group);
+    output.write(reinterpret_cast<const char*>(last_group), last.written);
+    return check_complete(last.status, decoder.current_state(), decoder.digest(), params);
+}
+
+// Function to get the number of bytes of mapped input
+unsigned long long input_size(const MappedFile& input) {
+    return input.size;
+}
+
+// Function to get the number of bytes of an input file within its range, UNKNOWN_SIZE for pipes and devices
+unsigned long long input_size(const InputFile& input) {
+#ifndef _WIN32
+    struct stat st;
+    if (input.seekable && fstat(input.fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        long long size = std::clamp<long long>(st.st_size, input.start, input.end);
+        return size - std::min(input.start, size);
+    }
+#endif
+    return UNKNOWN_SIZE;
+}
+
+// Function to get the number of bytes left in a seekable input stream, UNKNOWN_SIZE if it cannot seek
+unsigned long long input_size(std::istream& input) {
+    std::istream::pos_type position = input.tellg();
+    if (position == std::istream::pos_type(-1) || !input.seekg(0, std::ios::end)) {
+        input.clear();
+        return UNKNOWN_SIZE;
+    }
+    std::istream::pos_type end = input.tellg();
+    input.seekg(position);
+    return end == std::istream::pos_type(-1) ? UNKNOWN_SIZE : static_cast<unsigned long long>(end - position);
+}
+
+// Function to find the digest type of the trailer at the end of mapped input
+DigestType trailer_digest(const MappedFile& input) {
+    size_t size = std::min(input.size, DIGEST_TAIL_SIZE);
+    return detect_digest(std::span<const char>(input.data + input.size - size, size));
+}
+
+// Function to find the digest type of the trailer at the end of a regular input file, read with pread
+DigestType trailer_digest(const InputFile& input) {
+    unsigned long long size = input_size(input);
+    if (size == UNKNOWN_SIZE) {
+        return DigestType::None;
+    }
+#ifndef _WIN32
+    char tail[DIGEST_TAIL_SIZE];
+    size_t length = static_cast<size_t>(std::min<unsigned long long>(size, DIGEST_TAIL_SIZE));
+    ssize_t read_length = pread(input.fd, tail, length, input.start + size - length);
+    if (read_length > 0) {
+        return detect_digest(std::span<const char>(tail, read_length));
+    }
+#endif
+    return DigestType::None;
+}
+
+// Function to find the digest type of the trailer at the end of a seekable input stream
+DigestType trailer_digest(std::istream& input) {
+    unsigned long long size = input_size(input);
+    if (size == UNKNOWN_SIZE) {
+        return DigestType::None;
+    }
+    std::istream::pos_type position = input.tellg();
+    char tail[DIGEST_TAIL_SIZE];
+    size_t length = static_cast<size_t>(std::min<unsigned long long>(size, DIGEST_TAIL_SIZE));
+    input.seekg(-static_cast<std::streamoff>(length), std::ios::end);
+    input.read(tail, length);
+    size_t read_length = input.gcount();
+    input.clear();
+    input.seekg(position);
+    return detect_digest(std::span<const char>(tail, read_length));
+}
+
+// Function to handle input and determine whether to encode or decode
+template <typename Input>
+Status handle_input(Input& input, std::ostream& output, const Parameters& params) {
+    // Decoded data is written as is, header and footer only frame the encoded text.
+    // A digest trailer at the end of a whole file is verified without -digest.
+    if (!params.encode_mode) {
+        if (params.digest == DigestType::None && !has_range(params)) {
+            Parameters verified = params;
+            verified.digest = trailer_digest(input);
+            return decode(input, output, verified);
+        }
+        return decode(input, output, params);
+    }
+
+    // The size fields of header and footer are filled before the input is read
+    const unsigned long long size = input_size(input);
+    if (!params.header.empty()) {
+        output << fill_size(params.header, size);
+    }
+
+    Digest digest = encode(input, output, params);
+
+    // Languages without empty arrays get a body for an empty input
+    if (digest.size() == 0) {
+        output << params.empty_body;
+    }
+    if (!params.footer.empty()) {
+        output << fill_size(params.footer, size);
+    }
+
+    // A dump already ends with the line break of its last line
+    if (!params.dump) {
+        output << std::endl;
+    }
+    if (params.digest != DigestType::None) {
+        output << digest_trailer(params, digest);
+    }
+    return Status::Ok;
+}
+
+#ifndef _WIN32
+// Structure to hold a writable memory mapping of an output file
+struct MappedOutput {
+    int fd; // Output file
+    char* data; // First byte of the mapping
+    size_t size; // Size of the mapping in bytes
+};
+
+// Function to give an empty output file the given size with its blocks allocated up front and map it into memory.
+// Returns false if there is no room for the file or it cannot be mapped, the file is left empty then.
+bool map_output_file(int fd, size_t size, MappedOutput& output) {
+    StageTimer timer(Stage::Write);
+    output = MappedOutput{ fd, nullptr, size };
+#ifdef __linux__
+    // File systems without fallocate get a sparse file
+    bool is_sized = fallocate(fd, 0, 0, size) == 0 || (errno == EOPNOTSUPP && ftruncate(fd, size) == 0);
+#else
+    bool is_sized = ftruncate(fd, size) == 0;
+#endif
+    if (is_sized) {
+#ifdef MAP_POPULATE
+        const int flags = MAP_SHARED | MAP_POPULATE; // The pages are set up at once instead of on the first write to each
+#else
+        const int flags = MAP_SHARED;
+#endif
+        void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+        if (data != MAP_FAILED) {
+            output.data = static_cast<char*>(data);
+            return true;
+        }
+    }
+
+    // The output is written through the buffer instead
+    if (ftruncate(fd, 0) != 0) {
+        throw std::runtime_error("Failed to resize the output file");
+    }
+    return false;
+}
+
+// Function to release the mapping of an output file and cut the file to the number of bytes written
+void unmap_output_file(MappedOutput& output, size_t size) {
+    StageTimer timer(Stage::Write, size);
+    munmap(output.data, output.size);
+    if (ftruncate(output.fd, size) != 0) {
+        throw std::runtime_error("Failed to resize the output file");
+    }
+}
+
+// Function to encode a chunk into its part of a mapped output file without writing past the part. Blocks that surely
+// fit are encoded in place, the blocks near the end of the part through a scratch buffer.
+// Returns false if the text of the chunk does not fit into the part.
+bool encode_into_part(const unsigned char* data, size_t size, bool is_final, EncoderState& state, const Format& format, const Parameters& params, char* part, size_t part_size, size_t& written) {
+    std::vector<char> scratch;
+    written = 0;
+    for (size_t offset = 0; offset < size; offset += INPUT_BLOCK_SIZE) {
+        const size_t block_size = std::min(INPUT_BLOCK_SIZE, size - offset);
+        const bool is_last_block = is_final && offset + block_size == size;
+        const size_t bound = encoded_block_bound(block_size, params);
+        if (bound <= part_size - written) {
+            written += encode_block(data + offset, block_size, is_last_block, state, format, part + written);
+            continue;
+        }
+        scratch.resize(bound);
+        const size_t length = encode_block(data + offset, block_size, is_last_block, state, format, scratch.data());
+        if (length > part_size - written) {
+            return false;
+        }
+        memcpy(part + written, scratch.data(), length);
+        written += length;
+    }
+    return true;
+}
+
+// Function to decode a chunk of text into its part of a mapped output file without writing past the part, like
+// encode_into_part. Decoding stops at an invalid character, consumed is the number of characters decoded.
+// Returns false if the bytes of the chunk do not fit into the part.
+bool decode_into_part(const char* data, size_t size, DecoderState& state, const DecodeFormat& format, unsigned char* part, size_t part_size, size_t& written, size_t& consumed) {
+    std::vector<char> digits;
+    std::vector<unsigned char> scratch;
+    written = 0;
+    consumed = 0;
+    while (consumed < size) {
+        const size_t block_size = std::min(INPUT_BLOCK_SIZE, size - consumed);
+        const size_t bound = std::max(max_decoded_size(block_size, format.codec), MAX_GROUP_SIZE);
+        size_t block_consumed;
+        size_t length;
+        if (bound <= part_size - written) {
+            length = decode_block(data + consumed, block_size, state, format, digits, part + written, block_consumed);
+        } else {
+            scratch.resize(bound);
+            length = decode_block(data + consumed, block_size, state, format, digits, scratch.data(), block_consumed);
+            if (length > part_size - written) {
+                return false;
+            }
+            memcpy(part + written, scratch.data(), length);
+        }
+        written += length;
+        consumed += block_consumed;
+        if (block_consumed < block_size) {
+            break;
+        }
+    }
+    return true;
+}
+
+// Function to calculate the number of characters of the encoded body before an input byte that starts a line.
+// The bytes from there on are encoded like a whole input, except that they continue a line instead of opening the first one.
+size_t encoded_prefix_size(size_t input_size, size_t offset, const Parameters& params) {
+    if (offset == 0) {
+        return 0;
+    }
+    Parameters rest = params;
+    rest.range_offset += offset; // Dumps show the offsets of the bytes
+    const size_t rest_size = encoded_size(input_size - offset, rest) - (params.dump ? 0 : params.line_start.length());
+    return encoded_size(input_size, params) - rest_size;
+}
+
+// Function to encode mapped input straight into an empty output file. The size of the text follows from the size of
+// the input, so the file is allocated once and mapped, and every chunk is encoded by a worker into its own part of it.
+// Returns false if the file cannot be mapped or a chunk does not fill its part exactly, the file is left empty then.
+bool encode_to_file(const MappedFile& input, int fd, const Parameters& params) {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(input.data);
+    const std::string header = fill_size(params.header, input.size);
+    const std::string footer = (input.size == 0 ? params.empty_body : "") + fill_size(params.footer, input.size) + (params.dump ? "" : "\n"); // A dump already ends with a line break
+    const size_t body_size = encoded_size(input.size, params);
+    Digest digest(params.digest);
+    const size_t trailer_size = params.digest == DigestType::None ? 0 : digest_trailer(params, digest).length();
+    const size_t text_size = header.length() + body_size + footer.length() + trailer_size;
+
+    const size_t chunk_size = parallel_chunk_size(params);
+    MappedOutput output;
+    if (!map_output_file(fd, text_size, output)) {
+        return false;
+    }
+
+    WorkerPool pool(params.threads);
+    std::deque<std::pair<size_t, std::future<bool>>> pending;
+    const Format format = compile_format(params);
+    bool is_exact = true;
+
+    // The digest is taken over the chunks in order while the workers encode the following ones
+    auto finish_next = [&] {
+        size_t offset = pending.front().first;
+        is_exact = pending.front().second.get() && is_exact;
+        pending.pop_front();
+        digest.update(std::span<const unsigned char>(data + offset, std::min(chunk_size, input.size - offset)));
+    };
+
+    for (size_t offset = 0; offset < input.size; offset += chunk_size) {
+        const size_t size = std::min(chunk_size, input.size - offset);
+        const bool is_final = offset + size == input.size;
+        const size_t begin = encoded_prefix_size(input.size, offset, params);
+        const size_t end = is_final ? body_size : encoded_prefix_size(input.size, offset + size, params);
+        char* part = output.data + header.length() + begin;
+
+        // Every chunk holds whole lines, so it is encoded from the first column
+        pending.emplace_back(offset, pool.submit([data, offset, size, is_final, part, part_size = end - begin, &format, &params] {
+            StageTimer timer(Stage::Transform, size);
+            EncoderState state;
+            state.offset = offset;
+            size_t length;
+            if (!encode_into_part(data + offset, size, is_final, state, format, params, part, part_size, length)) {
+                return false;
+            }
+
+            // Add a newline if there are remaining columns
+            if (is_final && state.column_count != 0) {
+                if (length == part_size) {
+                    return false;
+                }
+                part[length++] = '\n';
+            }
+            return length == part_size;
+        }));
+
+        if (pending.size() >= static_cast<size_t>(params.threads) * 2) {
+            finish_next();
+        }
+    }
+    while (!pending.empty()) {
+        finish_next();
+    }
+    if (!is_exact) {
+        unmap_output_file(output, 0);
+        return false;
+    }
+
+    char* out = output.data;
+    memcpy(out, header.data(), header.length());
+    out += header.length() + body_size;
+    memcpy(out, footer.data(), footer.length());
+    if (params.digest != DigestType::None) {
+        std::string trailer = digest_trailer(params, digest);
+        memcpy(out + footer.length(), trailer.data(), trailer.length());
+    }
+    unmap_output_file(output, text_size);
+    session->statistics.mapped_output = true;
+    return true;
+}
+
+#endif
+
+// Stream buffer passing a range of the bytes written to it on to the output, the bytes around it are dropped
+class RangeOutput : public std::streambuf {
+public:
+    RangeOutput(std::ostream& output, unsigned long long skip, unsigned long long length)
+        : output(output), skip(skip), length(length) {
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            char byte = traits_type::to_char_type(ch);
+            xsputn(&byte, 1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char* data, std::streamsize size) override {
+        unsigned long long skipped = std::min<unsigned long long>(skip, size);
+        unsigned long long count = std::min<unsigned long long>(length, size - skipped);
+        output.write(data + skipped, count);
+        skip -= skipped;
+        length -= count;
+        return size;
+    }
+
+    int sync() override {
+        output.flush();
+        return 0;
+    }
+
+private:
+    std::ostream& output;
+    unsigned long long skip; // Bytes still to drop before the range
+    unsigned long long length; // Bytes of the range still to pass on
+};
+
+// Stream buffer reading a range of the bytes of an input stream. Streams that cannot seek are read up to the range.
+class RangeInput : public std::streambuf {
+public:
+    RangeInput(std::istream& input, unsigned long long offset, unsigned long long length, size_t buffer_size)
+        : input(input), remaining(length), buffer(buffer_size) {
+        if (offset > 0 && !input.seekg(offset, std::ios::cur)) {
+            input.clear();
+            while (offset > 0 && input.ignore(std::min<unsigned long long>(offset, buffer_size))) {
+                offset -= input.gcount();
+            }
+        }
+    }
+
+protected:
+    int_type underflow() override {
+        input.read(buffer.data(), std::min<unsigned long long>(buffer.size(), remaining));
+        size_t length = input.gcount();
+        if (length == 0) {
+            return traits_type::eof();
+        }
+        remaining -= length;
+        setg(buffer.data(), buffer.data(), buffer.data() + length);
+        return traits_type::to_int_type(buffer[0]);
+    }
+
+private:
+    std::istream& input;
+    unsigned long long remaining; // Bytes of the range not read yet
+    std::vector<char> buffer;
+};
+
+// Part of an encoded file holding a range of decoded bytes
+struct TextWindow {
+    unsigned long long start = 0; // First character of the line holding the first byte of the range
+    unsigned long long end = 0; // End of the line holding the last byte of the range
+    unsigned long long skip = 0; // Decoded bytes of the window before the range
+};
+
+// Function to get the position of a line of encoded text whose lines have the length of the first one,
+// the lines of a dump get one character longer at every further power of 16 of their offsets
+unsigned long long line_position(unsigned long long line, size_t line_length, size_t columns, bool dump) {
+    unsigned long long position = line * line_length;
+    if (dump) {
+        for (size_t digits = MIN_DUMP_OFFSET_DIGITS; digits < 2 * sizeof(unsigned long long); ++digits) {
+            unsigned long long first_line = ((1ULL << (digits * 4)) + columns - 1) / columns;
+            if (first_line >= line) {
+                break;
+            }
+            position += line - first_line;
+        }
+    }
+    return position;
+}
+
+// Structure to describe the fixed layout of encoded text, whose lines have the length of the first line of the body
+// and hold as many bytes
+struct TextLayout {
+    size_t body_start = 0; // First character of the body
+    size_t line_length = 0; // Characters of a line including its line break
+    size_t columns = 0; // Decoded bytes of a line
+};
+
+// Function to copy bytes of a mapped input from a position, returns the number of bytes copied. An empty
+// input has no mapping, so nothing is copied from its null address.
+size_t read_mapped(const MappedFile& input, unsigned long long position, size_t size, char* buffer) {
+    if (position >= input.size) {
+        return 0;
+    }
+    size = static_cast<size_t>(std::min<unsigned long long>(size, input.size - position));
+    memcpy(buffer, input.data + position, size);
+    return size;
+}
+
+// Function to find the layout of an encoded file from its header and the first line of its body. The file has to start
+// with the header of the parameters or of the detected language preset. Returns false if the first line does not end
+// on a byte boundary. The parameters are set up with the detected preset.
+template <typename ReadAt>
+bool find_text_layout(ReadAt read_at, unsigned long long file_size, Parameters& params, TextLayout& layout) {
+    std::vector<char> text(static_cast<size_t>(std::min<unsigned long long>(file_size, MAX_LAYOUT_LINE_LENGTH)));
+    text.resize(read_at(0, text.size(), text.data()));
+    if (params.auto_detect) {
+        const char* lang = detect_language(std::span<const char>(text.data(), text.size()), params.codec);
+        if (lang != nullptr) {
+            set_language_settings(lang, params);
+        }
+        params.auto_detect = false;
+    }
+    if (text.empty()) {
+        return false; // An empty text has no lines to search
+    }
+
+    // The first line of the body gives the line length and the number of bytes per line
+    size_t body_start = params.header.length();
+    if (params.header.find(SIZE_FIELD) != std::string::npos) {
+        // The size field has the length of the number, the body starts after the lines of the header
+        body_start = 0;
+        for (size_t lines = std::count(params.header.begin(), params.header.end(), '\n'); lines > 0; --lines) {
+            const char* line_end = static_cast<const char*>(memchr(text.data() + body_start, '\n', text.size() - body_start));
+            if (line_end == nullptr) {
+                return false;
+            }
+            body_start = line_end + 1 - text.data();
+        }
+        Decoder header_decoder(params);
+        std::vector<unsigned char> bytes(max_decoded_size(body_start, params.codec));
+        Result header = header_decoder.update(std::span<const char>(text.data(), body_start), bytes);
+        if (header.status != Status::Ok || header.written != 0 || header_decoder.current_state().phase != DecoderPhase::Body
+            || header_decoder.current_state().error_count != 0) {
+            return false;
+        }
+    } else if (text.size() < body_start || params.header.compare(0, body_start, text.data(), body_start) != 0) {
+        return false;
+    }
+    const char* line_end = static_cast<const char*>(memchr(text.data() + body_start, '\n', text.size() - body_start));
+    if (line_end == nullptr) {
+        return false;
+    }
+    const size_t line_length = line_end + 1 - (text.data() + body_start);
+    Parameters body_params = params;
+    body_params.header.clear(); // The line is decoded on its own
+    Decoder decoder(body_params);
+    std::vector<unsigned char> bytes(max_decoded_size(line_length, params.codec));
+    Result first_line = decoder.update(std::span<const char>(text.data() + body_start, line_length), bytes);
+    if (first_line.status != Status::Ok || first_line.written == 0 || decoder.pending_digit() != '\0') {
+        return false;
+    }
+    layout.body_start = body_start;
+    layout.line_length = line_length;
+    layout.columns = first_line.written;
+    return true;
+}
+
+// Function to find the lines of an encoded file holding the decoded byte range without reading the text before them.
+// The lines have the layout of find_text_layout. Returns false if the lines around the range do not end where
+// this layout puts them, the file is then decoded from the start. The parameters are set up to decode the window.
+template <typename ReadAt>
+bool locate_range(ReadAt read_at, unsigned long long file_size, Parameters& params, TextWindow& window) {
+    TextLayout layout;
+    if (!find_text_layout(read_at, file_size, params, layout)) {
+        return false;
+    }
+    params.header.clear(); // The window starts in the body
+    const size_t body_start = layout.body_start;
+    const size_t line_length = layout.line_length;
+    const size_t columns = layout.columns;
+
+    unsigned long long line = params.range_offset / columns;
+    window.start = body_start + line_position(line, line_length, columns, params.dump);
+    window.skip = params.range_offset - line * columns;
+    window.end = file_size;
+    if (params.range_length < WHOLE_INPUT - params.range_offset) {
+        unsigned long long end_line = (params.range_offset + params.range_length + columns - 1) / columns;
+        window.end = std::min(file_size, body_start + line_position(end_line, line_length, columns, params.dump));
+    }
+
+    // Both ends of the window have to follow a line break
+    auto follows_line_break = [&](unsigned long long position) {
+        char ch = '\0';
+        return position == body_start || (position <= file_size && read_at(position - 1, 1, &ch) == 1 && ch == '\n');
+    };
+    return window.start < file_size && follows_line_break(window.start) && (window.end == file_size || follows_line_break(window.end));
+}
+
+#ifndef _WIN32
+// Structure to hold the result of decoding one chunk straight into the output file
+struct PlacedChunk {
+    size_t written; // Number of bytes written to the part of the chunk
+    size_t consumed; // Number of characters decoded before an invalid character
+    bool fits; // Flag to indicate that the bytes of the chunk fit into its part
+    DecoderState state; // State of the decoder at the end of the chunk
+};
+
+// Function to decode mapped text of a fixed layout straight into an empty output file. The layout gives the place of
+// every chunk of whole lines in the file, so the file is allocated once and mapped, and every chunk is decoded by a
+// worker into its own part of it; the part of the last chunk is cut to the bytes it holds. Returns false if the text
+// has another layout or any error or the file cannot be mapped, the file is left empty then.
+bool decode_to_file(const MappedFile& input, int fd, const Parameters& params, Status& status) {
+    Parameters decode_params = params;
+    TextLayout layout;
+    auto read_at = [&input](unsigned long long position, size_t size, char* buffer) {
+        return read_mapped(input, position, size, buffer);
+    };
+    if (!find_text_layout(read_at, input.size, decode_params, layout)) {
+        return false;
+    }
+    const DecodeFormat format = compile_decode_format(decode_params);
+
+    // Chunks start on a line of the body, the first one with the header and the last one holds the footer
+    const size_t chunk_lines = std::max<size_t>(1, PARALLEL_CHUNK_SIZE / layout.line_length);
+    const size_t chunk_size = chunk_lines * layout.columns;
+    auto text_offset = [&](size_t chunk) {
+        return chunk == 0 ? 0 : layout.body_start + line_position(chunk * chunk_lines, layout.line_length, layout.columns, decode_params.dump);
+    };
+    size_t chunks = 1;
+    while (text_offset(chunks) < input.size) {
+        chunks++;
+    }
+    const size_t last_offset = (chunks - 1) * chunk_size;
+    const size_t last_text_size = static_cast<size_t>(input.size - text_offset(chunks - 1));
+    MappedOutput output;
+    if (!map_output_file(fd, last_offset + std::max(max_decoded_size(last_text_size, format.codec), MAX_GROUP_SIZE), output)) {
+        return false;
+    }
+    unsigned char* bytes = reinterpret_cast<unsigned char*>(output.data);
+
+    WorkerPool pool(params.threads);
+    std::deque<std::pair<size_t, std::future<PlacedChunk>>> pending;
+    DecoderState boundary_state;
+    boundary_state.phase = DecoderPhase::Body;
+    boundary_state.is_empty = false; // Bytes were decoded before the chunk
+    DecoderState state;
+    Digest digest(params.digest);
+    size_t written = 0;
+    bool is_exact = true;
+
+    // Every chunk but the last has to fill its part and end on a byte boundary, it was then decoded as in one piece
+    auto finish_next = [&] {
+        const size_t chunk = pending.front().first;
+        PlacedChunk result = pending.front().second.get();
+        pending.pop_front();
+        const bool is_last = chunk == chunks - 1;
+        const size_t text_size = static_cast<size_t>((is_last ? input.size : text_offset(chunk + 1)) - text_offset(chunk));
+        is_exact = is_exact && result.fits && result.consumed == text_size && result.state.error_count == 0
+            && (is_last || (result.written == chunk_size && result.state.is_byte_boundary()));
+        if (is_exact) {
+            digest.update(std::span<const unsigned char>(bytes + chunk * chunk_size, result.written));
+            written = chunk * chunk_size + result.written;
+        }
+        state = std::move(result.state);
+    };
+
+    // Text with more bytes per line than the first line does not fit, its chunk stops at the end of its part
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        const size_t begin = static_cast<size_t>(text_offset(chunk));
+        const size_t end = static_cast<size_t>(chunk == chunks - 1 ? input.size : text_offset(chunk + 1));
+        const size_t part_size = chunk == chunks - 1 ? output.size - last_offset : chunk_size;
+        pending.emplace_back(chunk, pool.submit([&input, begin, end, part = bytes + chunk * chunk_size, part_size, is_first = chunk == 0, &boundary_state, &format] {
+            StageTimer timer(Stage::Transform, end - begin);
+            PlacedChunk result;
+            result.state = is_first ? DecoderState() : boundary_state;
+            result.fits = decode_into_part(input.data + begin, end - begin, result.state, format, part, part_size, result.written, result.consumed);
+            return result;
+        }));
+
+        if (pending.size() >= static_cast<size_t>(params.threads) * 2) {
+            finish_next();
+        }
+    }
+    while (!pending.empty()) {
+        finish_next();
+    }
+
+    // The incomplete last group of a codec is decoded once the input has ended
+    if (is_exact) {
+        unsigned char last[MAX_GROUP_SIZE];
+        size_t last_size = decode_last_group(state, format, last);
+        if (last_size > output.size - written) {
+            unmap_output_file(output, 0);
+            return false;
+        }
+        memcpy(bytes + written, last, last_size);
+        digest.update(std::span<const unsigned char>(bytes + written, last_size));
+        written += last_size;
+        is_exact = decode_end(state, format) == Status::Ok && check_digest(state, format, digest) == Status::Ok;
+    }
+    if (!is_exact) {
+        unmap_output_file(output, 0);
+        return false;
+    }
+    unmap_output_file(output, written);
+    session->statistics.mapped_output = true;
+    status = check_complete(Status::Ok, state, digest, params);
+    return true;
+}
+#endif
+
+// Function to convert mapped input on the worker threads straight into an empty output file at computed offsets
+// instead of writing the chunks in order. Returns false if the output cannot be written this way, nothing was written then.
+bool convert_to_file(const MappedFile& input, int fd, const Parameters& params, Status& status) {
+#ifdef _WIN32
+    return false; // The output is written through the buffer on Windows
+#else
+    if (params.threads <= 1) {
+        return false; // A single thread writes through the buffer
+    }
+    status = Status::Ok;
+    if (params.encode_mode) {
+        return encode_to_file(input, fd, params);
+    }
+
+    // A digest trailer at the end of a whole file is verified without -digest
+    Parameters verified = params;
+    if (params.digest == DigestType::None) {
+        verified.digest = trailer_digest(input);
+    }
+    return decode_to_file(input, fd, verified, status);
+#endif
+}
+
+// Function to convert a byte range of mapped input. Encoding maps only the pages of the range, decoding
+// seeks to the lines holding the range when the text has a fixed layout.
+Status handle_range(const MappedFile& input, std::ostream& output, const Parameters& params) {
+    MappedFile view = input;
+    if (params.encode_mode) {
+        unsigned long long offset = std::min<unsigned long long>(params.range_offset, input.size);
+        view.data = input.data + offset;
+        view.size = static_cast<size_t>(std::min<unsigned long long>(params.range_length, input.size - offset));
+        return handle_input(view, output, params);
+    }
+
+    Parameters window_params = params;
+    TextWindow window;
+    auto read_at = [&input](unsigned long long position, size_t size, char* buffer) {
+        return read_mapped(input, position, size, buffer);
+    };
+    if (locate_range(read_at, input.size, window_params, window)) {
+        view.data = input.data + window.start;
+        view.size = static_cast<size_t>(window.end - window.start);
+    } else {
+        window_params = params;
+        window.skip = params.range_offset;
+    }
+    RangeOutput range_output(output, window.skip, params.range_length);
+    std::ostream range_stream(&range_output);
+    return handle_input(view, range_stream, window_params);
+}
+
+// Function to convert a byte range of an input file read with the pipeline, regular files are read with pread from the range on
+Status handle_range(InputFile& input, std::ostream& output, const Parameters& params) {
+    input.start = static_cast<long long>(std::min<unsigned long long>(params.range_offset, LLONG_MAX));
+    input.end = input.start + static_cast<long long>(std::min<unsigned long long>(params.range_length, LLONG_MAX - input.start));
+    if (params.encode_mode) {
+        return handle_input(input, output, params);
+    }
+
+    Parameters window_params = params;
+    TextWindow window;
+    window.skip = params.range_offset;
+    input.start = 0;
+    input.end = LLONG_MAX;
+#ifndef _WIN32
+    struct stat st;
+    if (input.seekable && fstat(input.fd, &st) == 0) {
+        auto read_at = [&input](unsigned long long position, size_t size, char* buffer) {
+            ssize_t length = pread(input.fd, buffer, size, position);
+            return length > 0 ? static_cast<size_t>(length) : 0;
+        };
+        if (locate_range(read_at, st.st_size, window_params, window)) {
+            input.start = window.start;
+            input.end = window.end;
+        } else {
+            window_params = params;
+            window.skip = params.range_offset;
+        }
+    }
+#endif
+    RangeOutput range_output(output, window.skip, params.range_length);
+    std::ostream range_stream(&range_output);
+    return handle_input(input, range_stream, window_params);
+}
+
+// Function to convert a byte range of an input stream, the input before the range is skipped by seeking or reading
+Status handle_range(std::istream& input, std::ostream& output, const Parameters& params) {
+    if (params.encode_mode) {
+        RangeInput range_input(input, params.range_offset, params.range_length, params.block_size);
+        std::istream range_stream(&range_input);
+        return handle_input(range_stream, output, params);
+    }
+
+    RangeOutput range_output(output, params.range_offset, params.range_length);
+    std::ostream range_stream(&range_output);
+    return handle_input(input, range_stream, params);
+}
+
+volatile std::sig_atomic_t interrupted = 0; // Flag set when interactive mode is stopped with Ctrl+C
+
+// Function to read the data currently available from the standard input, returns 0 at the end of the input
+size_t read_available(char* buffer, size_t size) {
+    StageTimer timer(Stage::Read);
+#ifdef _WIN32
+    int length = _read(_fileno(stdin), buffer, static_cast<unsigned int>(size));
+#else
+    ssize_t length;
+    do {
+        length = read(STDIN_FILENO, buffer, size);
+    } while (length < 0 && errno == EINTR);
+#endif
+    return length > 0 ? length : 0;
+}
+
+// Function to convert the standard input as it arrives, line by line in interactive mode.
+// Every piece of input is converted and flushed as soon as it is read, memory stays bounded by the block size.
+Status handle_stream(bool line_mode, std::ostream& output, const Parameters& params) {
+    // A header holding the input size is written once the whole input is read
+    if (params.encode_mode && params.header.find(SIZE_FIELD) != std::string::npos) {
+        std::ostringstream spool;
+        std::vector<char> buffer(params.block_size);
+        for (size_t length; (length = read_available(buffer.data(), buffer.size())) > 0;) {
+            spool.write(buffer.data(), length);
+        }
+        std::istringstream input(std::move(spool).str());
+        return has_range(params) ? handle_range(input, output, params) : handle_input(input, output, params);
+    }
+
+    Encoder encoder(params);
+    Decoder decoder(params);
+    std::vector<char> text(params.encode_mode ? encoder.max_output_size(params.block_size) : 0);
+    std::vector<unsigned char> bytes(params.encode_mode ? 0 : std::max(max_decoded_size(params.block_size, params.codec), MAX_GROUP_SIZE));
+
+    // A range of the input is cut from the pieces read, a range of the decoded bytes from the output
+    const unsigned long long range_end = params.range_offset + std::min(params.range_length, WHOLE_INPUT - params.range_offset);
+    unsigned long long position = 0;
+    RangeOutput range_output(output, params.range_offset, params.range_length);
+    std::ostream range_stream(&range_output);
+    std::ostream& decoded_output = has_range(params) ? range_stream : output;
+    unsigned long long encoded_bytes = 0; // Number of bytes encoded, filled into the footer
+
+    // Function to convert the next piece of input and flush the result
+    auto feed = [&](const char* data, size_t size) {
+        if (params.encode_mode && has_range(params)) {
+            unsigned long long begin = std::clamp(params.range_offset, position, position + size);
+            unsigned long long end = std::clamp(range_end, position, position + size);
+            data += begin - position;
+            position += size;
+            size = static_cast<size_t>(end - begin);
+        }
+        for (size_t offset = 0; offset < size; offset += params.block_size) {
+            std::span<const char> piece(data + offset, std::min(params.block_size, size - offset));
+            StageTimer timer(Stage::Transform, piece.size());
+            if (params.encode_mode) {
+                Result result = encoder.update(std::span<const unsigned char>(reinterpret_cast<const unsigned char*>(piece.data()), piece.size()), text);
+                timer.stop();
+                output.write(text.data(), result.written);
+                encoded_bytes += piece.size();
+            } else {
+                Result result = decoder.update(piece, bytes);
+                timer.stop();
+                decoded_output.write(reinterpret_cast<const char*>(bytes.data()), result.written);
+                if (result.status == Status::InvalidCharacter) {
+                    return report_invalid_character(piece[result.read], decoder.current_state().position, params);
+                }
+            }
+        }
+        output.flush();
+        return Status::Ok;
+    };
+
+    if (params.encode_mode && !params.header.empty()) {
+        output << params.header;
+    }
+    output.flush();
+
+    Status status = Status::Ok;
+    if (line_mode) {
+        // Ctrl+C ends the input like the end of the file, the held back byte and the footer are written then
+        std::string line;
+        while (status == Status::Ok && !interrupted) {
+            StageTimer timer(Stage::Read);
+            if (!std::getline(std::cin, line)) {
+                break;
+            }
+            timer.stop();
+            line += '\n';
+            status = feed(line.data(), line.size());
+        }
+    } else {
+        std::vector<char> buffer(params.block_size);
+        while (status == Status::Ok) {
+            size_t length = read_available(buffer.data(), buffer.size());
+            if (length == 0) {
+                break;
+            }
+            status = feed(buffer.data(), length);
+        }
+    }
+    if (status != Status::Ok) {
+        return status;
+    }
+
+    if (!params.encode_mode) {
+        Result last = decoder.finish(bytes);
+        decoded_output.write(reinterpret_cast<const char*>(bytes.data()), last.written);
+        return check_complete(last.status, decoder.current_state(), decoder.digest(), params);
+    }
+
+    Result result = encoder.finish(text);
+    output.write(text.data(), result.written);
+
+    // Languages without empty arrays get a body for an empty input
+    if (encoded_bytes == 0) {
+        output << params.empty_body;
+    }
+    if (!params.footer.empty()) {
+        output << fill_size(params.footer, encoded_bytes);
+    }
+
+    // A dump already ends with the line break of its last line
+    if (!params.dump) {
+        output << std::endl;
+    }
+    if (params.digest != DigestType::None) {
+        output << digest_trailer(params, encoder.digest());
+    }
+    return Status::Ok;
+}
+
+// Function to read the little-endian size in front of a record
+size_t record_size(const char* data) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    return bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast<size_t>(bytes[3]) << 24;
+}
+
+// Reader splitting the input into batches of whole records. A batch holds the records completed by one read,
+// so records are converted as soon as they arrive; memory is bounded by the read size and the largest record.
+class RecordReader {
+public:
+    RecordReader(std::function<size_t(char*, size_t)> read, RecordMode mode) : read(std::move(read)), mode(mode) {}
+
+    // Function to take the next batch, returns false at the end of the input
+    bool next(std::vector<char>& batch) {
+        batch.swap(pending);
+        pending.clear();
+        // The start of an incomplete record carried over has no delimiter
+        scanned = batch.size();
+        while (true) {
+            size_t complete = whole_records(batch);
+            if (complete > 0 || ended) {
+                if (ended && complete < batch.size()) {
+                    // The last line or string may end without a delimiter, a size promises more bytes
+                    if (mode == RecordMode::Len32) {
+                        throw std::runtime_error("Truncated record at the end of the input");
+                    }
+                    complete = batch.size();
+                }
+                pending.assign(batch.begin() + complete, batch.end());
+                batch.resize(complete);
+                return complete > 0;
+            }
+            size_t size = batch.size();
+            batch.resize(size + RECORD_READ_SIZE);
+            size_t length = read(batch.data() + size, RECORD_READ_SIZE);
+            batch.resize(size + length);
+            ended = length == 0;
+        }
+    }
+
+private:
+    // Function to find the end of the last whole record of a batch, delimiters are searched only in the bytes read
+    // since the last call so that a long record is not scanned again with every read
+    size_t whole_records(const std::vector<char>& batch) {
+        if (mode == RecordMode::Len32) {
+            size_t position = 0;
+            while (batch.size() - position >= 4 && batch.size() - position - 4 >= record_size(batch.data() + position)) {
+                position += 4 + record_size(batch.data() + position);
+            }
+            return position;
+        }
+        char delimiter = mode == RecordMode::Lines ? '\n' : '\0';
+        for (size_t position = batch.size(); position > scanned; --position) {
+            if (batch[position - 1] == delimiter) {
+                return position;
+            }
+        }
+        scanned = batch.size();
+        return 0;
+    }
+
+    std::function<size_t(char*, size_t)> read;
+    RecordMode mode;
+    std::vector<char> pending; // Start of an incomplete record read with the last batch
+    size_t scanned = 0; // Bytes of the batch searched for a delimiter without finding one
+    bool ended = false;
+};
+
+// Layouts of the records compiled once for the whole input
+struct RecordLayout {
+    RecordMode mode; // Delimiting of input and output records
+    Parameters params; // Parameters of every record
+    Format format; // Layout of encoded records
+    DecodeFormat decode_format; // Layout of records to decode
+    bool sized; // Flag to fill the size of every record into its header and footer
+};
+
+// Structure to hold the converted records of a batch
+struct ConvertedBatch {
+    std::vector<char> text; // Converted records with their delimiters
+    size_t records = 0; // Number of records converted
+    Status status = Status::Ok; // Error that stopped a strict decode in the record after the converted ones
+    char invalid_char = '\0'; // Invalid character or digit of the incomplete byte that stopped the decode
+    TextPosition position; // Position of the invalid character in its record
+    size_t error_count = 0; // Number of invalid characters skipped or replaced
+    size_t first_error_record = 0; // Record of the first invalid character skipped or replaced, counted in the batch
+    TextPosition first_error; // Position of that character in its record
+};
+
+// Function to convert one record and append it with its delimiter, returns false when a strict decode fails
+bool convert_record(const char* data, size_t size, const RecordLayout& layout, std::vector<char>& digits, ConvertedBatch& batch) {
+    const Parameters& params = layout.params;
+    size_t start = batch.text.size();
+    size_t length_field = layout.mode == RecordMode::Len32 ? 4 : 0;
+    size_t written = 0;
+
+    if (params.encode_mode) {
+        std::string header = layout.sized ? fill_size(params.header, size) : params.header;
+        std::string footer = (size == 0 ? params.empty_body : "") + (layout.sized ? fill_size(params.footer, size) : params.footer);
+        batch.text.resize(start + length_field + header.size() + encoded_block_bound(size, params) + footer.size() + 1);
+        char* out = batch.text.data() + start + length_field;
+        memcpy(out, header.data(), header.size());
+        written = header.size();
+        if (size > 0) {
+            EncoderState state;
+            written += encode_block(reinterpret_cast<const unsigned char*>(data), size, true, state, layout.format, out + written);
+        }
+        memcpy(out + written, footer.data(), footer.size());
+        written += footer.size();
+    } else {
+        batch.text.resize(start + length_field + max_decoded_size(size, params.codec) + MAX_GROUP_SIZE + 1);
+        unsigned char* out = reinterpret_cast<unsigned char*>(batch.text.data() + start + length_field);
+        DecoderState state;
+        for (size_t offset = 0; offset < size;) {
+            size_t piece = std::min(INPUT_BLOCK_SIZE, size - offset);
+            size_t consumed;
+            written += decode_block(data + offset, piece, state, layout.decode_format, digits, out + written, consumed);
+            if (consumed < piece) {
+                batch.status = Status::InvalidCharacter;
+                batch.invalid_char = data[offset + consumed];
+                batch.position = state.position;
+                batch.text.resize(start);
+                return false;
+            }
+            offset += piece;
+        }
+        written += decode_last_group(state, layout.decode_format, out + written);
+        Status status = decode_end(state, layout.decode_format);
+        if (status != Status::Ok) {
+            batch.status = status;
+            batch.invalid_char = state.pending_digits.back();
+            batch.text.resize(start);
+            return false;
+        }
+        if (state.error_count > 0 && batch.error_count == 0) {
+            batch.first_error_record = batch.records;
+            batch.first_error = state.first_error;
+        }
+        batch.error_count += state.error_count;
+    }
+
+    if (layout.mode == RecordMode::Len32) {
+        if (written > UINT32_MAX) {
+            throw std::runtime_error("Converted record larger than 4 GB");
+        }
+        for (size_t i = 0; i < 4; ++i) {
+            batch.text[start + i] = static_cast<char>(written >> (8 * i));
+        }
+    } else {
+        batch.text[start + written++] = layout.mode == RecordMode::Lines ? '\n' : '\0';
+    }
+    batch.text.resize(start + length_field + written);
+    batch.records++;
+    return true;
+}
+
+// Function to convert a batch of whole records, a strict decode stops at the first record with an error
+ConvertedBatch convert_records(const std::vector<char>& records, const RecordLayout& layout) {
+    StageTimer timer(Stage::Transform, records.size());
+    ConvertedBatch batch;
+    batch.text.reserve(layout.params.encode_mode ? encoded_block_bound(records.size(), layout.params) : records.size());
+    std::vector<char> digits;
+    const char* data = records.data();
+    const char* end = data + records.size();
+
+    while (data < end) {
+        size_t size;
+        if (layout.mode == RecordMode::Len32) {
+            size = record_size(data);
+            data += 4;
+        } else {
+            const char* delimiter = static_cast<const char*>(memchr(data, layout.mode == RecordMode::Lines ? '\n' : '\0', end - data));
+            size = (delimiter != nullptr ? delimiter : end) - data;
+        }
+        if (!convert_record(data, size, layout, digits, batch)) {
+            break;
+        }
+        data += size + (layout.mode == RecordMode::Len32 || data + size == end ? 0 : 1);
+    }
+    return batch;
+}
+
+// Function to convert every record of the input into one output record, batches of records are converted on
+// the worker threads and written in input order. The standard input is converted as it arrives.
+Status handle_records(std::istream& input, std::ostream& output, RecordMode mode, const Parameters& params) {
+    RecordReader reader(&input == &std::cin ? std::function<size_t(char*, size_t)>(read_available) : [&input](char* data, size_t size) {
+        StageTimer timer(Stage::Read);
+        input.read(data, size);
+        return static_cast<size_t>(input.gcount());
+    }, mode);
+
+    std::vector<char> records;
+    if (!reader.next(records)) {
+        return Status::Ok;
+    }
+
+    // The language preset is detected from the first record
+    RecordLayout layout{ mode, params };
+    if (params.auto_detect) {
+        const char* lang = detect_language(std::span<const char>(records.data(), records.size()), params.codec);
+        if (lang != nullptr) {
+            set_language_settings(lang, layout.params);
+        }
+    }
+    if (params.encode_mode) {
+        layout.format = compile_format(layout.params);
+    } else {
+        layout.decode_format = compile_decode_format(layout.params);
+    }
+    layout.sized = layout.params.header.find(SIZE_FIELD) != std::string::npos || layout.params.footer.find(SIZE_FIELD) != std::string::npos;
+
+    std::unique_ptr<WorkerPool> pool = params.threads > 1 ? std::make_unique<WorkerPool>(params.threads) : nullptr;
+    std::deque<std::future<ConvertedBatch>> pending;
+    size_t record_count = 0;
+    size_t error_count = 0;
+    size_t first_error_record = 0;
+    TextPosition first_error;
+
+    auto write_next = [&] {
+        ConvertedBatch batch = pending.front().get();
+        pending.pop_front();
+        output.write(batch.text.data(), batch.text.size());
+        output.flush();
+        if (batch.error_count > 0 && error_count == 0) {
+            first_error_record = record_count + batch.first_error_record + 1;
+            first_error = batch.first_error;
+        }
+        error_count += batch.error_count;
+        record_count += batch.records;
+
+        std::string record = std::to_string(record_count + 1);
+        if (batch.status == Status::InvalidCharacter) {
+            print_message(*session->errors, "Invalid character: " + std::string(1, batch.invalid_char) + " in record " + record + " at " + format_position(batch.position), params.max_chars);
+        } else if (batch.status == Status::IncompleteByte) {
+            print_message(*session->errors, incomplete_message(batch.invalid_char, params) + " in record " + record, params.max_chars);
+        }
+        return batch.status;
+    };
+
+    do {
+        auto batch = std::make_shared<std::vector<char>>(std::move(records));
+        if (pool) {
+            pending.push_back(pool->submit([batch, &layout] { return convert_records(*batch, layout); }));
+        } else {
+            std::promise<ConvertedBatch> converted;
+            converted.set_value(convert_records(*batch, layout));
+            pending.push_back(converted.get_future());
+        }
+        if (pending.size() >= (pool ? static_cast<size_t>(params.threads) * 2 : 1)) {
+            Status status = write_next();
+            if (status != Status::Ok) {
+                return status;
+            }
+        }
+        records = std::vector<char>();
+    } while (reader.next(records));
+
+    while (!pending.empty()) {
+        Status status = write_next();
+        if (status != Status::Ok) {
+            return status;
+        }
+    }
+
+    if (error_count > 0) {
+        std::string action = params.errors == ErrorMode::Skip ? "Skipped " : "Replaced ";
+        print_message(*session->errors, action + std::to_string(error_count) + " invalid characters, the first in record " + std::to_string(first_error_record) + " at " + format_position(first_error), params.max_chars);
+    }
+    return Status::Ok;
+}
+
+// Function to check whether a file name matches a mask with * and ? wildcards
+bool match_mask(const std::string& name, const std::string& mask) {
+    size_t n = 0, m = 0;
+    size_t star = std::string::npos, star_name = 0;
+
+    while (n < name.length()) {
+        if (m < mask.length() && (mask[m] == '?' || mask[m] == name[n])) {
+            n++;
+            m++;
+        } else if (m < mask.length() && mask[m] == '*') {
+            star = m++;
+            star_name = n;
+        } else if (star != std::string::npos) {
+            // Let the last star take one more character
+            m = star + 1;
+            n = ++star_name;
+        } else {
+            return false;
+        }
+    }
+    while (m < mask.length() && mask[m] == '*') {
+        m++;
+    }
+    return m == mask.length();
+}
+
+// Function to expand directories and file masks into the list of input files.
+// Files found for one name are sorted, so the order of the list does not depend on the file system.
+bool expand_input_files(const std::vector<std::string>& names, std::vector<std::string>& files, const Parameters& params) {
+    namespace fs = std::filesystem;
+
+    for (const std::string& name : names) {
+        fs::path path(name);
+        fs::path directory;
+        std::string mask = path.filename().string();
+        std::error_code error;
+
+        if (fs::is_directory(session_path(name), error)) {
+            directory = path;
+            mask = "*";
+        } else if (mask.find_first_of("*?") != std::string::npos) {
+            directory = path.parent_path();
+        } else {
+            files.push_back(name);
+            continue;
+        }
+
+        std::vector<std::string> matches;
+        for (const fs::directory_entry& entry : fs::directory_iterator(session_path(directory.empty() ? "." : directory.string()), error)) {
+            std::string file_name = entry.path().filename().string();
+            if (entry.is_regular_file(error) && match_mask(file_name, mask)) {
+                matches.push_back((directory / file_name).string());
+            }
+        }
+        if (matches.empty()) {
+            print_message(*session->errors, "No files found: " + name, params.max_chars);
+            return false;
+        }
+        std::sort(matches.begin(), matches.end());
+        files.insert(files.end(), matches.begin(), matches.end());
+    }
+    return true;
+}
+
+// Function to build the name of the output file of an input file in the output directory
+std::string get_output_file_name(const std::string& file_name, const std::string& output_dir, const Parameters& params) {
+    std::filesystem::path name = std::filesystem::path(file_name).filename();
+    if (params.encode_mode) {
+        name += params.file_extension.empty() ? ".hex" : params.file_extension;
+    } else if (name.has_extension()) {
+        name.replace_extension();
+    } else {
+        name += ".bin";
+    }
+    return (std::filesystem::path(output_dir) / name).string();
+}
+
+// Function to write the stub of a preset that lets the compiler or assembler read the input file itself.
+// In an output file the input is referenced relative to the directory of the output when the stub looks there,
+// like #embed, and by its absolute name otherwise; on the standard output by the name it was given with.
+// Only the size of the input is read.
+bool write_stub(const std::string& file_name, std::ostream& output, const Parameters& params) {
+    namespace fs = std::filesystem;
+    std::error_code error;
+    unsigned long long size = fs::file_size(session_path(file_name), error);
+    if (error) {
+        print_message(*session->errors, "Failed to open file: " + file_name, params.max_chars);
+        return false;
+    }
+    std::string reference = file_name;
+    if (!params.stub_directory.empty()) {
+        fs::path input = fs::absolute(session_path(file_name), error).lexically_normal();
+        fs::path directory = fs::absolute(session_path(params.stub_directory), error).lexically_normal();
+        if (!directory.has_filename()) {
+            directory = directory.parent_path(); // Trailing separator
+        }
+        fs::path relative = params.stub_relative ? input.lexically_relative(directory) : fs::path();
+        reference = (error || relative.empty() ? input : relative).generic_string(); // Other drives are referenced absolutely
+    }
+
+    // The name is written into a string literal
+    std::string name;
+    for (char ch : reference) {
+        if (ch == '\\' || ch == '"') {
+            name += '\\';
+        }
+        name += ch;
+    }
+    std::string stub = params.stub;
+    const std::string field = FILE_FIELD;
+    for (size_t position = stub.find(field); position != std::string::npos; position = stub.find(field, position + name.length())) {
+        stub.replace(position, field.length(), name);
+    }
+
+    output << fill_size(params.header, size) << stub << fill_size(params.footer, size) << std::endl;
+    return true;
+}
+
+// Function to convert a single input file. Local regular files are mapped into memory, other files are read
+// by the pipeline, or through a stream when the conversion runs on several threads or under a memory limit.
+bool convert_file(const std::string& file_name, std::ostream& output, InputMode input_mode, RecordMode records, const Parameters& params) {
+    if (!params.stub.empty()) {
+        return write_stub(file_name, output, params);
+    }
+    if (records != RecordMode::None) {
+        std::ifstream input(session_path(file_name), std::ios::binary);
+        if (!input) {
+            print_message(*session->errors, "Failed to open file: " + file_name, params.max_chars);
+            return false;
+        }
+        return handle_records(input, output, records, params) == Status::Ok;
+    }
+
+    Status status;
+    MappedFile* mapped_input = map_file(file_name, input_mode);
+    if (mapped_input != nullptr) {
+        // An output file of its own is written by the workers at computed offsets
+        OutputBuffer* output_buffer = dynamic_cast<OutputBuffer*>(output.rdbuf());
+        int output_fd = output_buffer != nullptr && !has_range(params) ? output_buffer->empty_file() : -1;
+        if (output_fd < 0 || !convert_to_file(*mapped_input, output_fd, params, status)) {
+            status = has_range(params) ? handle_range(*mapped_input, output, params) : handle_input(*mapped_input, output, params);
+        }
+        unmap_file(mapped_input);
+    } else if (params.threads > 1 || input_mode == InputMode::Stream) {
+        // Under a memory limit the blocks are read straight into the buffers of the conversion
+        std::ifstream input;
+        if (input_mode == InputMode::Stream) {
+            input.rdbuf()->pubsetbuf(nullptr, 0);
+        }
+        input.open(session_path(file_name));
+        if (!input) {
+            print_message(*session->errors, "Failed to open file: " + file_name, params.max_chars);
+            return false;
+        }
+        status = has_range(params) ? handle_range(input, output, params) : handle_input(input, output, params);
+    } else {
+        InputFile input;
+        if (!open_input_file(file_name, input)) {
+            print_message(*session->errors, "Failed to open file: " + file_name, params.max_chars);
+            return false;
+        }
+        try {
+            status = has_range(params) ? handle_range(input, output, params) : handle_input(input, output, params);
+        } catch (...) {
+            close_input_file(input);
+            throw;
+        }
+        close_input_file(input);
+    }
+    return status == Status::Ok;
+}
+
+// Structure to hold the result of converting one input file
+struct ConvertedFile {
+    bool success; // Flag to indicate that the file was converted without errors
+    std::string text; // Converted data for concatenated output, empty when written to its own file
+};
+
+// Function to convert many input files on a pool of worker threads. Every file is converted by one worker;
+// the results are written to the output in the order of the list, or to one file per input in the output directory.
+// A single thread converts the files one after another straight into the output instead of holding their text.
+bool handle_files(const std::vector<std::string>& files, std::ostream& output, const std::string& output_dir, InputMode input_mode, RecordMode records, FlushPolicy flush_policy, size_t buffer_size, const Parameters& params) {
+    Parameters file_params = params;
+    file_params.threads = 1;
+
+    // Output names are made of the file names only, two inputs of the same name would overwrite each other
+    if (!output_dir.empty()) {
+        std::map<std::string, std::string> sources;
+        for (const std::string& file_name : files) {
+            std::string output_file_name = get_output_file_name(file_name, output_dir, params);
+            auto [source, is_new] = sources.emplace(output_file_name, file_name);
+            if (!is_new) {
+                print_message(*session->errors, "Input files " + source->second + " and " + file_name + " would both be written to " + output_file_name, params.max_chars);
+                return false;
+            }
+        }
+    }
+
+    if (!output_dir.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(session_path(output_dir), error);
+        if (error) {
+            print_message(*session->errors, "Failed to create output directory: " + output_dir, params.max_chars);
+            return false;
+        }
+    } else if (params.threads == 1) {
+        bool success = true;
+        for (const std::string& file_name : files) {
+            bool converted;
+            try {
+                converted = convert_file(file_name, output, input_mode, records, file_params);
+            } catch (const std::exception& e) {
+                print_message(*session->errors, "Error: " + std::string(e.what()), params.max_chars);
+                converted = false;
+            }
+            if (!converted) {
+                print_message(*session->errors, "Failed to convert file: " + file_name, params.max_chars);
+                success = false;
+            }
+        }
+        return success;
+    }
+
+    WorkerPool pool(params.threads);
+    std::deque<std::future<ConvertedFile>> pending;
+    size_t written_files = 0;
+    bool success = true;
+
+    auto write_next = [&] {
+        ConvertedFile result;
+        try {
+            result = pending.front().get();
+        } catch (const std::exception& e) {
+            print_message(*session->errors, "Error: " + std::string(e.what()), params.max_chars);
+            result.success = false;
+        }
+        pending.pop_front();
+        output.write(result.text.data(), result.text.size());
+        if (!result.success) {
+            print_message(*session->errors, "Failed to convert file: " + files[written_files], params.max_chars);
+            success = false;
+        }
+        written_files++;
+    };
+
+    for (const std::string& file_name : files) {
+        pending.push_back(pool.submit([&file_name, &output_dir, input_mode, records, flush_policy, buffer_size, &file_params] {
+            ConvertedFile result;
+            if (output_dir.empty()) {
+                std::ostringstream text;
+                result.success = convert_file(file_name, text, input_mode, records, file_params);
+                result.text = text.str();
+                return result;
+            }
+
+            std::string output_file_name = get_output_file_name(file_name, output_dir, file_params);
+            int output_fd = open_output_file(output_file_name);
+            if (output_fd < 0) {
+                print_message(*session->errors, "Failed to open output file: " + output_file_name, file_params.max_chars);
+                result.success = false;
+                return result;
+            }
+            OutputBuffer output_buffer(output_fd, true, flush_policy, nullptr, buffer_size);
+            std::ostream file_output(&output_buffer);
+            result.success = convert_file(file_name, file_output, input_mode, records, file_params);
+            if (!output_buffer.finish()) {
+                print_message(*session->errors, "Failed to write output file: " + output_file_name, file_params.max_chars);
+                result.success = false;
+            }
+            return result;
+        }));
+
+        if (pending.size() >= static_cast<size_t>(params.threads) * 2) {
+            write_next();
+        }
+    }
+    while (!pending.empty()) {
+        write_next();
+    }
+
+    return success;
+}
+
+// Function to make a C identifier of a name, other characters become underscores
+std::string make_symbol(const std::string& name) {
+    std::string symbol = name;
+    for (char& ch : symbol) {
+        if (!isalnum(static_cast<unsigned char>(ch))) {
+            ch = '_';
+        }
+    }
+    if (symbol.empty() || isdigit(static_cast<unsigned char>(symbol[0]))) {
+        symbol.insert(0, 1, '_');
+    }
+    return symbol;
+}
+
+// Function to rename the array of a C preset. The presets call it data and its size data_size.
+std::string rename_symbol(const std::string& text, const std::string& symbol) {
+    const std::string name = "data";
+    std::string renamed;
+    size_t start = 0;
+    for (size_t position = text.find(name); position != std::string::npos; position = text.find(name, position + name.length())) {
+        bool starts_word = position == 0 || !(isalnum(static_cast<unsigned char>(text[position - 1])) || text[position - 1] == '_');
+        size_t end = position + name.length();
+        bool ends_word = end == text.length() || !isalnum(static_cast<unsigned char>(text[end]));
+        if (starts_word && ends_word) {
+            renamed += text.substr(start, position - start) + symbol;
+            start = end;
+        }
+    }
+    return renamed + text.substr(start);
+}
+
+// Function to read the contents of a text file, returns an empty string when it does not exist
+std::string read_text_file(const std::string& file_name) {
+    std::ifstream input(session_path(file_name), std::ios::binary);
+    std::ostringstream text;
+    text << input.rdbuf();
+    return text.str();
+}
+
+// Function to write a text file unless it already has the same contents, so its modification time only changes with them
+bool update_text_file(const std::string& file_name, const std::string& text, const Parameters& params) {
+    if (read_text_file(file_name) == text) {
+        return true;
+    }
+    std::ofstream output(session_path(file_name), std::ios::binary | std::ios::trunc);
+    output << text;
+    if (!output.flush()) {
+        print_message(*session->errors, "Failed to write output file: " + file_name, params.max_chars);
+        return false;
+    }
+    return true;
+}
+
+// Function to hash the contents of a file with xxHash64, returns false when it cannot be read
+bool hash_file(const std::string& file_name, InputMode input_mode, unsigned long long& hash, unsigned long long& size) {
+    Digest digest(DigestType::XxHash64);
+    MappedFile* mapped_input = map_file(file_name, input_mode);
+    if (mapped_input != nullptr) {
+        StageTimer timer(Stage::Read, mapped_input->size);
+        digest.update(std::span<const unsigned char>(reinterpret_cast<const unsigned char*>(mapped_input->data), mapped_input->size));
+        size = mapped_input->size;
+        unmap_file(mapped_input);
+    } else {
+        std::ifstream input(session_path(file_name), std::ios::binary);
+        if (!input) {
+            return false;
+        }
+        std::vector<char> buffer(INPUT_BLOCK_SIZE);
+        size = 0;
+        while (input.read(buffer.data(), buffer.size()) || input.gcount() > 0) {
+            StageTimer timer(Stage::Read, input.gcount());
+            digest.update(std::span<const unsigned char>(reinterpret_cast<const unsigned char*>(buffer.data()), input.gcount()));
+            size += input.gcount();
+        }
+    }
+    hash = digest.value();
+    return true;
+}
+
+// Function to describe every parameter that changes the encoded output, the manifest is rebuilt when it changes
+std::string parameters_key(const Parameters& params) {
+    std::ostringstream key;
+    key << VERSION << '\n' << params.upper_case << ' ' << static_cast<int>(params.separator) << ' ' << params.suppress_last_postfix << ' '
+        << params.max_columns << ' ' << params.word_size << ' ' << params.dump << ' ' << params.group_size << ' '
+        << static_cast<int>(params.digest) << '\n' << params.prefix << '\n' << params.postfix << '\n' << params.header << '\n'
+        << params.footer << '\n' << params.line_start << '\n' << params.line_end << '\n' << params.stub << '\n'
+        << params.comment << '\n' << params.file_extension;
+    Digest digest(DigestType::XxHash64);
+    std::string text = key.str();
+    digest.update(std::span<const unsigned char>(reinterpret_cast<const unsigned char*>(text.data()), text.size()));
+    std::ostringstream hash;
+    hash << std::hex << std::setfill('0') << std::setw(16) << digest.value();
+    return hash.str();
+}
+
+// Structure to hold one compiled resource
+struct Resource {
+    bool success = false; // Flag to indicate that the source is up to date
+    std::string name; // File name of the input, listed in the index
+    std::string symbol; // Name of the array in the source and the index
+    std::string output_file_name; // Generated source
+    unsigned long long hash = 0; // xxHash64 of the input
+    unsigned long long size = 0; // Size of the input in bytes
+};
+
+// Function to compile input files into C sources in the output directory, one per file, and an index header declaring
+// all of them. A manifest of input hashes and options next to the index skips inputs whose source is up to date,
+// so only sources of changed inputs are written; the index and the manifest are only written when they change.
+bool handle_resources(const std::vector<std::string>& files, const std::string& output_dir, const std::string& index_name, InputMode input_mode, FlushPolicy flush_policy, const Parameters& params) {
+    namespace fs = std::filesystem;
+    const std::string prefix = make_symbol(fs::path(index_name).stem().string());
+
+    // Sources and symbols are named after the file names, inputs whose names give the same source, array or
+    // size macro would overwrite each other or break the index
+    std::map<std::string, std::string> sources;
+    std::map<std::string, std::string> symbols;
+    for (const std::string& file_name : files) {
+        std::string output_file_name = get_output_file_name(file_name, output_dir, params);
+        auto [source, is_new_source] = sources.emplace(output_file_name, file_name);
+        if (!is_new_source) {
+            print_message(*session->errors, "Input files " + source->second + " and " + file_name + " would both be compiled to " + output_file_name, params.max_chars);
+            return false;
+        }
+        std::string size_macro = make_symbol(prefix + "_" + fs::path(file_name).filename().string());
+        std::transform(size_macro.begin(), size_macro.end(), size_macro.begin(), ::toupper);
+        auto [symbol, is_new_symbol] = symbols.emplace(size_macro, file_name);
+        if (!is_new_symbol) {
+            print_message(*session->errors, "Input files " + symbol->second + " and " + file_name + " would get the same array name, rename one of them", params.max_chars);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    fs::create_directories(session_path(output_dir), error);
+    if (error) {
+        print_message(*session->errors, "Failed to create output directory: " + output_dir, params.max_chars);
+        return false;
+    }
+
+    const std::string index_file_name = (fs::path(output_dir) / index_name).string();
+    const std::string manifest_file_name = (fs::path(output_dir) / (fs::path(index_name).stem().string() + ".manifest")).string();
+    // Lines of an array end with the postfix too, so every source compiles; a comma may follow the last byte
+    Parameters file_params = params;
+    file_params.threads = 1;
+    if (file_params.line_end.empty()) {
+        file_params.line_end = file_params.postfix;
+    }
+    const std::string key = parameters_key(file_params) + ' ' + index_name;
+
+    // Manifest: the parameters key, then the hash and source of every resource
+    std::map<std::string, unsigned long long> built;
+    std::istringstream manifest(read_text_file(manifest_file_name));
+    std::string line;
+    if (std::getline(manifest, line) && line == key) {
+        while (std::getline(manifest, line)) {
+            if (line.length() > 17) {
+                built[line.substr(17)] = strtoull(line.substr(0, 16).c_str(), nullptr, 16);
+            }
+        }
+    }
+
+    WorkerPool pool(params.threads);
+    std::vector<std::future<Resource>> pending;
+    for (const std::string& file_name : files) {
+        pending.push_back(pool.submit([&file_name, &output_dir, &prefix, &built, input_mode, flush_policy, &file_params] {
+            Resource resource;
+            resource.name = fs::path(file_name).filename().string();
+            resource.symbol = make_symbol(prefix + "_" + resource.name);
+            resource.output_file_name = get_output_file_name(file_name, output_dir, file_params);
+            if (!hash_file(file_name, input_mode, resource.hash, resource.size)) {
+                print_message(*session->errors, "Failed to open file: " + file_name, file_params.max_chars);
+                return resource;
+            }
+            auto entry = built.find(resource.output_file_name);
+            std::error_code exists_error;
+            if (entry != built.end() && entry->second == resource.hash && fs::exists(session_path(resource.output_file_name), exists_error)) {
+                resource.success = true;
+                return resource;
+            }
+
+            int output_fd = open_output_file(resource.output_file_name);
+            if (output_fd < 0) {
+                print_message(*session->errors, "Failed to open output file: " + resource.output_file_name, file_params.max_chars);
+                return resource;
+            }
+            Parameters resource_params = file_params;
+            resource_params.header = rename_symbol(file_params.header, resource.symbol);
+            resource_params.footer = rename_symbol(file_params.footer, resource.symbol);
+            OutputBuffer output_buffer(output_fd, true, flush_policy);
+            std::ostream file_output(&output_buffer);
+            resource.success = convert_file(file_name, file_output, input_mode, RecordMode::None, resource_params);
+            if (!output_buffer.finish()) {
+                print_message(*session->errors, "Failed to write output file: " + resource.output_file_name, file_params.max_chars);
+                resource.success = false;
+            }
+            return resource;
+        }));
+    }
+
+    // The index declares the definitions of header and footer with the includes they need
+    std::vector<Resource> resources;
+    bool success = true;
+    for (size_t i = 0; i < pending.size(); ++i) {
+        try {
+            resources.push_back(pending[i].get());
+        } catch (const std::exception& e) {
+            print_message(*session->errors, "Error: " + std::string(e.what()), params.max_chars);
+            resources.push_back(Resource());
+        }
+        if (!resources.back().success) {
+            print_message(*session->errors, "Failed to convert file: " + files[i], params.max_chars);
+            success = false;
+        }
+    }
+
+    std::set<std::string> includes = { "#include <stddef.h>" };
+    std::istringstream layout(params.header + '\n' + params.footer);
+    std::vector<std::string> definitions;
+    while (std::getline(layout, line)) {
+        if (line.compare(0, 9, "#include ") == 0) {
+            includes.insert(line);
+        } else if (line.find(" = ") != std::string::npos) {
+            definitions.push_back("extern " + line.substr(0, line.find(" = ")) + ";");
+        }
+    }
+    std::string guard = prefix;
+    std::transform(guard.begin(), guard.end(), guard.begin(), ::toupper);
+
+    std::ostringstream index;
+    index << "// Generated by base16, do not edit" << std::endl << "#ifndef " << guard << "_H" << std::endl << "#define " << guard << "_H" << std::endl << std::endl;
+    for (const std::string& include : includes) {
+        index << include << std::endl;
+    }
+    index << std::endl << "#ifdef __cplusplus" << std::endl << "extern \"C\" {" << std::endl << "#endif" << std::endl << std::endl;
+    for (const Resource& resource : resources) {
+        std::string size_macro = resource.symbol + "_SIZE";
+        std::transform(size_macro.begin(), size_macro.end(), size_macro.begin(), ::toupper);
+        index << "#define " << size_macro << " " << resource.size << std::endl;
+        for (const std::string& definition : definitions) {
+            index << fill_size(rename_symbol(definition, resource.symbol), resource.size) << std::endl;
+        }
+    }
+    index << std::endl << "// Name, bytes and size of every resource" << std::endl
+          << "static const struct { const char* name; const void* data; size_t size; } " << prefix << "[] = {" << std::endl;
+    for (const Resource& resource : resources) {
+        std::string name;
+        for (char ch : resource.name) {
+            if (ch == '\\' || ch == '"') {
+                name += '\\';
+            }
+            name += ch;
+        }
+        index << "    { \"" << name << "\", " << resource.symbol << ", " << resource.size << " }," << std::endl;
+    }
+    index << "};" << std::endl << "#define " << guard << "_COUNT " << resources.size() << std::endl << std::endl
+          << "#ifdef __cplusplus" << std::endl << "}" << std::endl << "#endif" << std::endl << std::endl << "#endif // " << guard << "_H" << std::endl;
+    success = update_text_file(index_file_name, index.str(), params) && success;
+
+    // Sources of inputs that are gone are removed, failed ones are built again next time
+    std::ostringstream new_manifest;
+    new_manifest << key << std::endl;
+    std::set<std::string> outputs;
+    for (const Resource& resource : resources) {
+        if (resource.success) {
+            new_manifest << std::hex << std::setfill('0') << std::setw(16) << resource.hash << std::dec << ' ' << resource.output_file_name << std::endl;
+        }
+        outputs.insert(resource.output_file_name);
+    }
+    for (const auto& entry : built) {
+        if (!outputs.count(entry.first)) {
+            fs::remove(session_path(entry.first), error);
+        }
+    }
+    return update_text_file(manifest_file_name, new_manifest.str(), params) && success;
+}
+
+// Format of the -stats report
+enum class StatsFormat {
+    None, // No report
+    Text, // Human-readable lines
+    Json, // One JSON object
+};
+
+// Function to get the peak resident set size of the process in kilobytes
+size_t peak_rss_kb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize / 1024;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // Reported in bytes
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+// Function to get the time spent in a stage in seconds
+double stage_seconds(Stage stage) {
+    return session->statistics.nanoseconds[static_cast<int>(stage)] / 1e9;
+}
+
+// Function to print the statistics of the conversion to the standard error. Stage times are summed
+// over all threads, so with -j they can add up to more than the wall time.
+void print_statistics(StatsFormat format, double wall_seconds, const Parameters& params) {
+    unsigned long long input_bytes = session->statistics.bytes[static_cast<int>(Stage::Transform)];
+    unsigned long long output_bytes = session->statistics.bytes[static_cast<int>(Stage::Write)];
+    double mb_per_second = wall_seconds > 0 ? input_bytes / wall_seconds / (1024 * 1024) : 0;
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(3);
+    if (format == StatsFormat::Json) {
+        report << "{\"codec\":\"" << params.codec->name << "\",\"kernel\":\"" << params.kernel->name << "\",\"threads\":" << params.threads
+               << ",\"mapped_output\":" << (session->statistics.mapped_output ? "true" : "false")
+               << ",\"input_bytes\":" << input_bytes << ",\"output_bytes\":" << output_bytes
+               << ",\"wall_seconds\":" << wall_seconds << ",\"mb_per_second\":" << mb_per_second
+               << ",\"read_seconds\":" << stage_seconds(Stage::Read) << ",\"transform_seconds\":" << stage_seconds(Stage::Transform)
+               << ",\"write_seconds\":" << stage_seconds(Stage::Write) << ",\"peak_rss_kb\":" << peak_rss_kb() << "}" << std::endl;
+    } else {
+        report << "Codec: " << params.codec->name << ", kernel: " << params.kernel->name << ", threads: " << params.threads
+               << (session->statistics.mapped_output ? ", output: mapped" : "") << std::endl
+               << "Input: " << input_bytes << " bytes, output: " << output_bytes << " bytes" << std::endl
+               << "Wall time: " << wall_seconds << " s, " << mb_per_second << " MB/s" << std::endl
+               << "Read: " << stage_seconds(Stage::Read) << " s, transform: " << stage_seconds(Stage::Transform)
+               << " s, write: " << stage_seconds(Stage::Write) << " s" << std::endl
+               << "Peak RSS: " << peak_rss_kb() << " KB" << std::endl;
+    }
+    *session->errors << report.str();
+}
+
+// Reporter printing a progress line to the standard error at a fixed interval on a background thread
+class ProgressReporter {
+public:
+    explicit ProgressReporter(double interval_seconds) : start(std::chrono::steady_clock::now()) {
+        thread = std::thread([this, interval_seconds, owner = session] {
+            session = owner;
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopping.wait_for(lock, std::chrono::duration<double>(interval_seconds), [this] { return stopped; })) {
+                print();
+            }
+        });
+    }
+
+    ~ProgressReporter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+        }
+        stopping.notify_one();
+        thread.join();
+    }
+
+private:
+    void print() {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double input_mb = session->statistics.bytes[static_cast<int>(Stage::Transform)] / (1024.0 * 1024);
+        double output_mb = session->statistics.bytes[static_cast<int>(Stage::Write)] / (1024.0 * 1024);
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(1) << "Progress: " << seconds << " s, input " << input_mb
+             << " MB, output " << output_mb << " MB, " << input_mb / seconds << " MB/s" << std::endl;
+        *session->errors << line.str();
+    }
+
+    std::chrono::steady_clock::time_point start;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable stopping;
+    bool stopped = false;
+};
+
+// Signal handler for interactive mode, the input loop stops and the conversion is finished on the main thread
+void signal_handler(int signum) {
+    interrupted = 1;
+}
+
+// Function to stop interactive mode with Ctrl+C. Reads are not restarted after the signal, so a read waiting
+// for the next line returns and the input loop sees the flag.
+void handle_interrupt() {
+#ifdef _WIN32
+    signal(SIGINT, signal_handler);
+#else
+    struct sigaction action = {};
+    action.sa_handler = signal_handler;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+#endif
+}
+
+
+// Function to parse a byte count with an optional K, M, G or T suffix
+unsigned long long parse_size(const std::string& value) {
+    if (value.empty() || !isdigit(static_cast<unsigned char>(value[0]))) {
+        throw std::invalid_argument(value);
+    }
+    size_t length;
+    unsigned long long size = std::stoull(value, &length);
+    std::string suffix = value.substr(length);
+    std::transform(suffix.begin(), suffix.end(), suffix.begin(), ::tolower);
+    int shift = suffix.empty() ? 0 : suffix == "k" ? 10 : suffix == "m" ? 20 : suffix == "g" ? 30 : suffix == "t" ? 40 : -1;
+    if (shift < 0) {
+        throw std::invalid_argument(value);
+    }
+    if (size > (WHOLE_INPUT >> shift)) {
+        throw std::out_of_range(value);
+    }
+    return size << shift;
+}
+
+// Function to count the bytes of the buffers a serial conversion allocates for blocks of the given size:
+// the block read, the text or bytes it converts to, and the digits the decoder compacts it into
+size_t block_memory(size_t block_size, const Parameters& params) {
+    if (params.encode_mode) {
+        return block_size + Encoder(params).max_output_size(block_size);
+    }
+    size_t digits = block_size * (params.codec->zero_group != '\0' ? params.codec->group_chars : 1) + MAX_GROUP_SIZE + DIGITS_PADDING;
+    if (params.dump || params.auto_detect) {
+        digits = std::max(digits, MAX_DUMP_COLUMNS * (HEX_BYTE_LENGTH + SEPARATOR_LENGTH) + DIGITS_PADDING);
+    }
+    return block_size + digits + std::max(max_decoded_size(block_size, params.codec), MAX_GROUP_SIZE);
+}
+
+// Function to find the largest block size whose buffers fit into the given number of bytes, 0 if even the smallest does not
+size_t limited_block_size(size_t memory, const Parameters& params) {
+    for (size_t size = INPUT_BLOCK_SIZE; size >= MIN_LIMITED_BLOCK_SIZE; size /= 2) {
+        if (block_memory(size, params) <= memory) {
+            return size;
+        }
+    }
+    return 0;
+}
+
+// Function to set up a language preset for the codec of the parameters, returns false after reporting an error
+bool set_language(const std::string& lang, Parameters& params) {
+    Status status = set_language_settings(lang, params);
+    if (status == Status::UnsupportedCodec) {
+        print_message(*session->errors, "The " + lang + " preset cannot hold " + params.codec->name + " text", params.max_chars);
+        return false;
+    }
+    if (status != Status::Ok) {
+        print_message(*session->errors, "Unknown language: " + lang, params.max_chars);
+        return false;
+    }
+    return true;
+}
+
+// Environment of a command: the process for the command line, a client for the server
+struct CommandContext {
+    std::istream* input = nullptr; // Standard input, nullptr when it is not redirected
+    Connection* connection = nullptr; // Client receiving the standard output, nullptr for the process
+    int width = DEFAULT_CONSOLE_WIDTH; // Width of the console for messages and the default line length
+};
+
+// Function to parse the command line and run the conversion, returns the exit code
+int run_command(int argc, char* argv[], const CommandContext& context) {
     Parameters params;
     params.encode_mode = true; // Default to encoding mode
     params.upper_case = true; // Default to uppercase
@@ -473,14 +3280,27 @@ int main(int argc, char* argv[]) {
     params.header = ""; // Header for the entire output
     params.footer = ""; // Footer for the entire output
     params.suppress_last_postfix = false; // Suppress postfix for the last byte
-    std::istream* input = is_stdin_redirected() ? &std::cin : nullptr; // Default input from stdin
-    std::ostream* output = &std::cout; // Default output to stdout
+    params.kernel = select_kernel(""); // Best kernel supported by the CPU
+    params.threads = 1; // Serial processing
+    std::istream* input = context.input; // Default input from stdin
+    std::unique_ptr<std::istream> text_stream; // Input of the -t option
+    std::unique_ptr<OutputBuffer> output_buffer; // Large buffer collecting the output
+    std::unique_ptr<std::ostream> output; // Output to stdout or the output file through output_buffer
+    FlushPolicy flush_policy = FlushPolicy::Block; // When the buffered output is written
     std::string text_input; // For storing text after -t or -text option
-    std::string file_name; // For storing file name after -f or -file option
+    std::vector<std::string> input_files; // For storing file names and masks after -f or -file option or without a key
+    std::string output_dir; // For storing output directory after -od or -outdir option
     std::string output_file_name; // For storing output file name after -o or -output option
+    std::string resource_index; // For storing index header name after -resources option
+    std::string language; // For storing the language preset after -lang or -language option
+    InputMode input_mode = InputMode::Auto; // How input files are read
+    RecordMode records = RecordMode::None; // Delimiting of the records of -records
     bool interactive_mode = false; // Interactive input mode
+    StatsFormat stats_format = StatsFormat::None; // Report of the -stats option
+    double progress_interval = 0; // Seconds between progress lines, 0 disables them
+    unsigned long long memory_limit = 0; // Ceiling of the conversion buffers of -mem in bytes, 0 without a limit
     params.max_columns = 8; // Maximum number of columns (bytes) per line
-    params.max_chars = get_output_width(); // Maximum number of characters per line
+    params.max_chars = context.width; // Maximum number of characters per line
     // Calculate the maximum number of columns to fit within the max_chars limit
     params.max_columns = calculate_max_columns(params.max_chars, params.prefix, params.postfix, params.separator);
 
@@ -501,35 +3321,35 @@ int main(int argc, char* argv[]) {
         // Check for encoding/decoding mode
         if (arg == "-d" || arg == "-decode") {
             if (seen_options.count("-e")) {
-                print_message(std::cerr, "Conflicting options: -d/-decode and -e/-encode cannot be used together", params.max_chars);
+                print_message(*session->errors, "Conflicting options: -d/-decode and -e/-encode cannot be used together", params.max_chars);
                 return 1;
             }
             params.encode_mode = false;
             seen_options.insert("-d");
         } else if (arg == "-e" || arg == "-encode") {
             if (seen_options.count("-d")) {
-                print_message(std::cerr, "Conflicting options: -e/-encode and -d/-decode cannot be used together", params.max_chars);
+                print_message(*session->errors, "Conflicting options: -e/-encode and -d/-decode cannot be used together", params.max_chars);
                 return 1;
             }
             params.encode_mode = true;
             seen_options.insert("-e");
         } else if (arg == "-l" || arg == "-lcase") {
             if (seen_options.count("-u")) {
-                print_message(std::cerr, "Conflicting options: -l/-lcase and -u/-ucase cannot be used together", params.max_chars);
+                print_message(*session->errors, "Conflicting options: -l/-lcase and -u/-ucase cannot be used together", params.max_chars);
                 return 1;
             }
             params.upper_case = false;
             seen_options.insert("-l");
         } else if (arg == "-u" || arg == "-ucase") {
             if (seen_options.count("-l")) {
-                print_message(std::cerr, "Conflicting options: -u/-ucase and -l/-lcase cannot be used together", params.max_chars);
+                print_message(*session->errors, "Conflicting options: -u/-ucase and -l/-lcase cannot be used together", params.max_chars);
                 return 1;
             }
             params.upper_case = true;
             seen_options.insert("-u");
         } else if (arg == "-s" || arg == "-separator") {
             if (seen_options.count("-s")) {
-                print_message(std::cerr, "Duplicate option: -s/-separator", params.max_chars);
+                print_message(*session->errors, "Duplicate option: -s/-separator", params.max_chars);
                 return 1;
             }
             // Check for separator argument
@@ -538,7 +3358,7 @@ int main(int argc, char* argv[]) {
                 if (separator_str.length() == 1) {
                     params.separator = separator_str[0];
                 } else {
-                    print_message(std::cerr, "Separator must be a single character", params.max_chars);
+                    print_message(*session->errors, "Separator must be a single character", params.max_chars);
                     return 1;
                 }
             } else {
@@ -547,202 +3367,1055 @@ int main(int argc, char* argv[]) {
             seen_options.insert("-s");
         } else if (arg == "-prefix") {
             if (seen_options.count("-prefix")) {
-                print_message(std::cerr, "Duplicate option: -prefix", params.max_chars);
+                print_message(*session->errors, "Duplicate option: -prefix", params.max_chars);
                 return 1;
             }
             // Check for prefix argument
             if (has_next_arg) {
                 params.prefix = argv[++i];
             } else {
-                print_message(std::cerr, "Missing prefix after -prefix option", params.max_chars);
+                print_message(*session->errors, "Missing prefix after -prefix option", params.max_chars);
                 return 1;
             }
             seen_options.insert("-prefix");
         } else if (arg == "-postfix") {
             if (seen_options.count("-postfix")) {
-                print_message(std::cerr, "Duplicate option: -postfix", params.max_chars);
+                print_message(*session->errors, "Duplicate option: -postfix", params.max_chars);
                 return 1;
             }
             // Check for postfix argument
             if (has_next_arg) {
                 params.postfix = argv[++i];
             } else {
-                print_message(std::cerr, "Missing postfix after -postfix option", params.max_chars);
+                print_message(*session->errors, "Missing postfix after -postfix option", params.max_chars);
                 return 1;
             }
             seen_options.insert("-postfix");
         } else if (arg == "-header") {
             if (seen_options.count("-header")) {
-                print_message(std::cerr, "Duplicate option: -header", params.max_chars);
+                print_message(*session->errors, "Duplicate option: -header", params.max_chars);
                 return 1;
             }
             // Check for header argument
             if (has_next_arg) {
                 params.header = argv[++i];
             } else {
-                print_message(std::cerr, "Missing header after -header option", params.max_chars);
+                print_message(*session->errors, "Missing header after -header option", params.max_chars);
                 return 1;
             }
             seen_options.insert("-header");
         } else if (arg == "-footer") {
             if (seen_options.count("-footer")) {
-                print_message(std::cerr, "Duplicate option: -footer", params.max_chars);
+                print_message(*session->errors, "Duplicate option: -footer", params.max_chars);
                 return 1;
             }
             // Check for footer argument
             if (has_next_arg) {
                 params.footer = argv[++i];
             } else {
-                print_message(std::cerr, "Missing footer after -footer option", params.max_chars);
+                print_message(*session->errors, "Missing footer after -footer option", params.max_chars);
                 return 1;
             }
             seen_options.insert("-footer");
         } else if (arg == "-lang" || arg == "-language") {
             if (seen_options.count("-lang")) {
-                print_message(std::cerr, "Duplicate option: -lang/-language", params.max_chars);
+                print_message(*session->errors, "Duplicate option: -lang/-language", params.max_chars);
                 return 1;
             }
             // Check for language argument
             if (has_next_arg) {
-                set_language_settings(argv[++i], params);
+                language = argv[++i];
+                if (!set_language(language, params)) {
+                    return 1;
+                }
             } else {
-                print_message(std::cerr, "Missing language after -lang/-language option", params.max_chars);
+                print_message(*session->errors, "Missing language after -lang/-language option", params.max_chars);
                 return 1;
             }
             seen_options.insert("-lang");
             // Warn if redundant options are used with -lang
             if (seen_options.count("-prefix")) {
-                print_message(std::cerr, "Warning: -prefix option is redundant when using -lang/-language", params.max_chars);
+                print_message(*session->errors, "Warning: -prefix option is redundant when using -lang/-language", params.max_chars);
             }
             if (seen_options.count("-postfix")) {
-                print_message(std::cerr, "Warning: -postfix option is redundant when using -lang/-language", params.max_chars);
+                print_message(*session->errors, "Warning: -postfix option is redundant when using -lang/-language", params.max_chars);
             }
             if (seen_options.count("-header")) {
-                print_message(std::cerr, "Warning: -header option is redundant when using -lang/-language", params.max_chars);
+                print_message(*session->errors, "Warning: -header option is redundant when using -lang/-language", params.max_chars);
             }
             if (seen_options.count("-footer")) {
-                print_message(std::cerr, "Warning: -footer option is redundant when using -lang/-language", params.max_chars);
+                print_message(*session->errors, "Warning: -footer option is redundant when using -lang/-language", params.max_chars);
             }
             if (seen_options.count("-s")) {
-                print_message(std::cerr, "Warning: -s/-separator option is redundant when using -lang/-language", params.max_chars);
+                print_message(*session->errors, "Warning: -s/-separator option is redundant when using -lang/-language", params.max_chars);
+            }
+        } else if (arg == "-t" || arg == "-text") {
+            if (seen_options.count("-t")) {
+                print_message(*session->errors, "Duplicate option: -t/-text", params.max_chars);
+                return 1;
+            }
+            // Check for text input argument
+            if (has_next_arg) {
+                text_input = argv[++i];
+                text_stream = std::make_unique<std::istringstream>(text_input);
+                input = text_stream.get();
+            } else {
+                print_message(*session->errors, "Missing text after -t/-text option", params.max_chars);
+                return 1;
+            }
+            seen_options.insert("-t");
+        } else if (arg == "-f" || arg == "-file") {
+            // Check for file input argument
+            if (has_next_arg) {
+                input_files.push_back(argv[++i]);
+            } else {
+                print_message(*session->errors, "Missing file name after -f/-file option", params.max_chars);
+                return 1;
+            }
+            seen_options.insert("-f");
+        } else if (arg == "-o" || arg == "-output") {
+            if (seen_options.count("-o")) {
+                print_message(*session->errors, "Duplicate option: -o/-output", params.max_chars);
+                return 1;
+            }
+            // Check for output file argument
+            if (has_next_arg) {
+                output_file_name = argv[++i];
+                /*if (!params.file_extension.empty()) {
+                    output_file_name += params.file_extension;
+                }*/
+            } else {
+                print_message(*session->errors, "Missing output file name after -o/-output option", params.max_chars);
+                return 1;
+            }
+            seen_options.insert("-o");
+        } else if (arg == "-od" || arg == "-outdir") {
+            if (seen_options.count("-od")) {
+                print_message(*session->errors, "Duplicate option: -od/-outdir", params.max_chars);
+                return 1;
+            }
+            // Check for output directory argument
+            if (has_next_arg) {
+                output_dir = argv[++i];
+            } else {
+                print_message(*session->errors, "Missing output directory after -od/-outdir option", params.max_chars);
+                return 1;
+            }
+            seen_options.insert("-od");
+        } else if (arg == "-resources") {
+            if (seen_options.count("-resources")) {
+                print_message(*session->errors, "Duplicate option: -resources", params.max_chars);
+                return 1;
+            }
+            // Check for index header argument
+            if (has_next_arg) {
+                resource_index = argv[++i];
+            } else {
+                print_message(*session->errors, "Missing index header name after -resources option", params.max_chars);
+                return 1;
+            }
+            seen_options.insert("-resources");
+        } else if (arg == "-flush") {
+            if (seen_options.count("-flush")) {
+                print_message(*session->errors, "Duplicate option: -flush", params.max_chars);
+                return 1;
+            }
+            // Check for flush policy argument
+            if (has_next_arg) {
+                std::string policy = argv[++i];
+                std::transform(policy.begin(), policy.end(), policy.begin(), ::tolower);
+                if (policy == "line") {
+                    flush_policy = FlushPolicy::Line;
+                } else if (policy == "block") {
+                    flush_policy = FlushPolicy::Block;
+                } else if (policy == "none") {
+                    flush_policy = FlushPolicy::None;
+                } else {
+                    print_message(*session->errors, "Invalid argument for -flush: " + policy, params.max_chars);
+                    return 1;
+                }
+            } else {
+                print_message(*session->errors, "Missing flush policy after -flush option", params.max_chars);
+                return 1;
+            }
+            seen_options.insert("-flush");
+        } else if (arg == "-errors") {
+            if (seen_options.count("-errors")) {
+                print_message(*session->errors, "Duplicate option: -errors", params.max_chars);
+                return 1;
+            }
+            // Check for error mode argument
+            if (has_next_arg) {
+                std::string mode = argv[++i];
+                std::transform(mode.begin(), mode.end(), mode.begin(), ::tolower);
+                if (mode == "strict") {
+                    params.errors = ErrorMode::Strict;
+                } else if (mode == "skip") {
+                    params.errors = ErrorMode::Skip;
+                } else if (mode == "replace") {
+                    params.errors = ErrorMode::Replace;
+                } else {
+                    print_message(*session->errors, "Invalid argument for -errors: " + mode, params.max_chars);
+                    return 1;
+                }
+            } else {
+                print_message(*session->errors, "Missing error mode after -errors option", params.max_chars);
+                return 1;
+            }
+            seen_options.insert("-errors");
+        } else if (arg == "-digest") {
+            if (seen_options.count("-digest")) {
+                print_message(*session->errors, "Duplicate option: -digest", params.max_chars);
+                return 1;
+            }
+            // Check for digest type argument
+            if (has_next_arg) {
+                std::string name = argv[++i];
+                std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+                params.digest = find_digest(name);
+                if (params.digest == DigestType::None) {
+                    print_message(*session->errors, "Invalid argument for -digest: " + name, params.max_chars);
+                    return 1;
+                }
+            } else {
+                print_message(*session->errors, "Missing digest type after -digest option", params.max_chars);
+                return 1;
+            }
+            seen_options.insert("-digest");
+        } else if (arg == "-stats") {
+            if (seen_options.count("-stats")) {
+                print_message(*session->errors, "Duplicate option: -stats", params.max_chars);
+                return 1;
+            }
+            // Check for report format argument, any other argument is left for the next option or an input file
+            std::string format = has_next_arg ? argv[i + 1] : "";
+            std::transform(format.begin(), format.end(), format.begin(), ::tolower);
+            if (format == "json") {
+                stats_format = StatsFormat::Json;
+                i++;
+            } else {
+                stats_format = StatsFormat::Text;
+                if (format == "text") {
+                    i++;
+                }
+            }
+            seen_options.insert("-stats");
+        } else if (arg == "-progress") {
+            if (seen_options.count("-progress")) {
+                print_message(*session->errors, "Duplicate option: -progress", params.max_chars);
+                return 1;
+            }
+            // Check for interval argument
+            if (has_next_arg) {
+                try {
+                    progress_interval = std::stod(argv[++i]);
+                } catch (const std::exception&) {
+                    progress_interval = 0;
+                }
+                if (progress_interval <= 0) {
+                    print_message(*session->errors, "Invalid argument for -progress: " + std::string(argv[i]), params.max_chars);
+                    return 1;
+                }
+            } else {
+                print_message(*session->errors, "Missing interval after -progress option", params.max_chars);
+                return 1;
+            }
+            seen_options.insert("-progress");
+        } else if (arg == "-io") {
+            if (seen_options.count("-io")) {
+                print_message(*session->errors, "Duplicate option: -io", params.max_chars);
+                return 1;
+            }
+            // Check for input mode argument
+            if (has_next_arg) {
+                std::string mode = argv[++i];
+                std::transform(mode.begin(), mode.end(), mode.begin(), ::tolower);
+                if (mode == "auto") {
+                    input_mode = InputMode::Auto;
+                } else if (mode == "mmap") {
+                    input_mode = InputMode::Map;
+                } else if (mode == "pipeline") {
+                    input_mode = InputMode::Pipeline;
+                } else {
+                    print_message(*session->errors, "Invalid argument for -io: " + mode, params.max_chars);
+                    return 1;
+                }
+            } else {
+                print_message(*session->errors, "Missing input mode after -io option", params.max_chars);
+                return 1;
+            }
+            seen_options.insert("-io");
+        } else if (arg == "-mem") {
+            if (seen_options.count("-mem")) {
+                print_message(*session->errors, "Duplicate option: -mem", params.max_chars);
+                return 1;
+            }
+            // Check for byte count argument
+            if (has_next_arg) {
+                try {
+                    memory_limit = parse_size(argv[++i]);
+                } catch (const std::invalid_argument& e) {
+                    print_message(*session->errors, "Invalid argument for -mem: " + std::string(argv[i]), params.max_chars);
+                    return 1;
+                } catch (const std::out_of_range& e) {
+                    print_message(*session->errors, "Argument for -mem out of range: " + std::string(argv[i]), params.max_chars);
+                    return 1;
+                }
+                if (memory_limit < MIN_MEMORY_LIMIT) {
+                    print_message(*session->errors, "Argument for -mem out of range: " + std::string(argv[i]) + " (at least 4K)", params.max_chars);
+                    return 1;
+                }
+            } else {
+                print_message(*session->errors, "Missing number of bytes after -mem option", params.max_chars);
+                return 1;
             }
-        } else if (arg == "-t" || arg == "-text") {
-            if (seen_options.count("-t")) {
-                print_message(std::cerr, "Duplicate option: -t/-text", params.max_chars);
+            seen_options.insert("-mem");
+        } else if (arg == "-records") {
+            if (seen_options.count("-records")) {
+                print_message(*session->errors, "Duplicate option: -records", params.max_chars);
                 return 1;
             }
-            // Check for text input argument
+            // Check for record delimiting argument
             if (has_next_arg) {
-                text_input = argv[++i];
-                input = new std::istringstream(text_input);
+                std::string mode = argv[++i];
+                std::transform(mode.begin(), mode.end(), mode.begin(), ::tolower);
+                if (mode == "lines") {
+                    records = RecordMode::Lines;
+                } else if (mode == "nul") {
+                    records = RecordMode::Nul;
+                } else if (mode == "len32") {
+                    records = RecordMode::Len32;
+                } else {
+                    print_message(*session->errors, "Invalid argument for -records: " + mode, params.max_chars);
+                    return 1;
+                }
             } else {
-                print_message(std::cerr, "Missing text after -t/-text option", params.max_chars);
+                print_message(*session->errors, "Missing record delimiting after -records option", params.max_chars);
                 return 1;
             }
-            seen_options.insert("-t");
-        } else if (arg == "-f" || arg == "-file") {
-            if (seen_options.count("-f")) {
-                print_message(std::cerr, "Duplicate option: -f/-file", params.max_chars);
+            seen_options.insert("-records");
+        } else if (arg == "-c" || arg == "-columns") {
+            if (seen_options.count("-c")) {
+                print_message(*session->errors, "Duplicate option: -c/-columns", params.max_chars);
                 return 1;
             }
-            // Check for file input argument
+            // Check for columns argument
             if (has_next_arg) {
-                file_name = argv[++i];
-                input = new std::ifstream(file_name);
-                if (!*input) {
-                    print_message(std::cerr, "Failed to open file: " + file_name, params.max_chars);
+                try {
+                    params.max_columns = std::stoi(argv[++i]);
+                } catch (const std::invalid_argument& e) {
+                    print_message(*session->errors, "Invalid argument for -c/-columns: " + std::string(argv[i]), params.max_chars);
+                    return 1;
+                } catch (const std::out_of_range& e) {
+                    print_message(*session->errors, "Argument for -c/-columns out of range: " + std::string(argv[i]), params.max_chars);
                     return 1;
                 }
             } else {
-                print_message(std::cerr, "Missing file name after -f/-file option", params.max_chars);
+                print_message(*session->errors, "Missing number of columns after -c/-columns option", params.max_chars);
                 return 1;
             }
-            seen_options.insert("-f");
-        } else if (arg == "-o" || arg == "-output") {
-            if (seen_options.count("-o")) {
-                print_message(std::cerr, "Duplicate option: -o/-output", params.max_chars);
+            seen_options.insert("-c");
+        } else if (arg == "-g") {
+            if (seen_options.count("-g")) {
+                print_message(*session->errors, "Duplicate option: -g", params.max_chars);
                 return 1;
             }
-            // Check for output file argument
+            // Check for group size argument
             if (has_next_arg) {
-                output_file_name = argv[++i];
-                /*if (!params.file_extension.empty()) {
-                    output_file_name += params.file_extension;
-                }*/
-                output = new std::ofstream(output_file_name);
-                if (!*output) {
-                    print_message(std::cerr, "Failed to open output file: " + output_file_name, params.max_chars);
+                try {
+                    params.group_size = std::stoi(argv[++i]);
+                } catch (const std::invalid_argument& e) {
+                    print_message(*session->errors, "Invalid argument for -g: " + std::string(argv[i]), params.max_chars);
+                    return 1;
+                } catch (const std::out_of_range& e) {
+                    print_message(*session->errors, "Argument for -g out of range: " + std::string(argv[i]), params.max_chars);
+                    return 1;
+                }
+                if (params.group_size < 0) {
+                    print_message(*session->errors, "Invalid argument for -g: " + std::string(argv[i]), params.max_chars);
                     return 1;
                 }
             } else {
-                print_message(std::cerr, "Missing output file name after -o/-output option", params.max_chars);
+                print_message(*session->errors, "Missing group size after -g option", params.max_chars);
                 return 1;
             }
-            seen_options.insert("-o");
-        } else if (arg == "-c" || arg == "-columns") {
-            if (seen_options.count("-c")) {
-                print_message(std::cerr, "Duplicate option: -c/-columns", params.max_chars);
+            seen_options.insert("-g");
+        } else if (arg == "-offset" || arg == "-length") {
+            if (seen_options.count(arg)) {
+                print_message(*session->errors, "Duplicate option: " + arg, params.max_chars);
                 return 1;
             }
-            // Check for columns argument
+            // Check for byte count argument
             if (has_next_arg) {
                 try {
-                    params.max_columns = std::stoi(argv[++i]);
+                    (arg == "-offset" ? params.range_offset : params.range_length) = parse_size(argv[++i]);
                 } catch (const std::invalid_argument& e) {
-                    print_message(std::cerr, "Invalid argument for -c/-columns: " + std::string(argv[i]), params.max_chars);
+                    print_message(*session->errors, "Invalid argument for " + arg + ": " + std::string(argv[i]), params.max_chars);
                     return 1;
                 } catch (const std::out_of_range& e) {
-                    print_message(std::cerr, "Argument for -c/-columns out of range: " + std::string(argv[i]), params.max_chars);
+                    print_message(*session->errors, "Argument for " + arg + " out of range: " + std::string(argv[i]), params.max_chars);
                     return 1;
                 }
             } else {
-                print_message(std::cerr, "Missing number of columns after -c/-columns option", params.max_chars);
+                print_message(*session->errors, "Missing number of bytes after " + arg + " option", params.max_chars);
                 return 1;
             }
-            seen_options.insert("-c");
+            seen_options.insert(arg);
         } else if (arg == "-i" || arg == "-input") {
             if (seen_options.count("-i")) {
-                print_message(std::cerr, "Duplicate option: -i/-input", params.max_chars);
+                print_message(*session->errors, "Duplicate option: -i/-input", params.max_chars);
+                return 1;
+            }
+            if (context.connection != nullptr) {
+                print_message(*session->errors, "Interactive input mode is not available through the server", params.max_chars);
                 return 1;
             }
             // Enable interactive mode
             interactive_mode = true;
-            signal(SIGINT, signal_handler);
+            handle_interrupt();
             seen_options.insert("-i");
+        } else if (arg == "-j") {
+            if (seen_options.count("-j")) {
+                print_message(*session->errors, "Duplicate option: -j", params.max_chars);
+                return 1;
+            }
+            // Check for thread count argument
+            if (has_next_arg) {
+                try {
+                    params.threads = std::stoi(argv[++i]);
+                } catch (const std::invalid_argument& e) {
+                    print_message(*session->errors, "Invalid argument for -j: " + std::string(argv[i]), params.max_chars);
+                    return 1;
+                } catch (const std::out_of_range& e) {
+                    print_message(*session->errors, "Argument for -j out of range: " + std::string(argv[i]), params.max_chars);
+                    return 1;
+                }
+                if (params.threads < 0) {
+                    print_message(*session->errors, "Invalid argument for -j: " + std::string(argv[i]), params.max_chars);
+                    return 1;
+                }
+                if (params.threads == 0) {
+                    params.threads = std::max(1u, std::thread::hardware_concurrency());
+                }
+            } else {
+                print_message(*session->errors, "Missing number of threads after -j option", params.max_chars);
+                return 1;
+            }
+            seen_options.insert("-j");
+        } else if (arg == "-kernel") {
+            if (seen_options.count("-kernel")) {
+                print_message(*session->errors, "Duplicate option: -kernel", params.max_chars);
+                return 1;
+            }
+            // Check for kernel argument
+            if (has_next_arg) {
+                std::string kernel_name = argv[++i];
+                std::transform(kernel_name.begin(), kernel_name.end(), kernel_name.begin(), ::tolower);
+                params.kernel = select_kernel(kernel_name);
+                if (params.kernel == nullptr) {
+                    print_message(*session->errors, "Unknown kernel or not supported by this CPU: " + kernel_name, params.max_chars);
+                    return 1;
+                }
+            } else {
+                print_message(*session->errors, "Missing kernel name after -kernel option", params.max_chars);
+                return 1;
+            }
+            seen_options.insert("-kernel");
+        } else if (arg == "-codec") {
+            if (seen_options.count("-codec")) {
+                print_message(*session->errors, "Duplicate option: -codec", params.max_chars);
+                return 1;
+            }
+            // Check for codec argument
+            if (has_next_arg) {
+                std::string codec_name = argv[++i];
+                std::transform(codec_name.begin(), codec_name.end(), codec_name.begin(), ::tolower);
+                params.codec = select_codec(codec_name);
+                if (params.codec == nullptr) {
+                    print_message(*session->errors, "Unknown codec: " + codec_name + " (use " + codec_names() + ")", params.max_chars);
+                    return 1;
+                }
+            } else {
+                print_message(*session->errors, "Missing codec name after -codec option", params.max_chars);
+                return 1;
+            }
+            seen_options.insert("-codec");
+            // A language preset given before is set up again for the text of the codec
+            if (seen_options.count("-lang") && !set_language(language, params)) {
+                return 1;
+            }
+        } else if (arg[0] != '-') {
+            // Arguments without a key are input files
+            input_files.push_back(argv[i]);
         } else {
             // Invalid argument
-            print_message(std::cerr, "Invalid argument: " + arg, params.max_chars);
+            print_message(*session->errors, "Invalid argument: " + arg, params.max_chars);
             print_help(argv[0], params.max_chars);
             return 1;
         }
     }
+
+    // Decoding detects the language preset from the header unless the layout is given
+    params.auto_detect = !params.encode_mode && !seen_options.count("-lang") && !seen_options.count("-prefix")
+        && !seen_options.count("-postfix") && !seen_options.count("-header") && !seen_options.count("-footer");
+
+    // A dump has 16 bytes per line and lowercase digits like xxd unless -c or -u is given, detected dumps too
+    if (params.dump || params.auto_detect) {
+        if (!seen_options.count("-c")) {
+            params.max_columns = DUMP_COLUMNS;
+        }
+        params.max_columns = std::clamp<int>(params.max_columns, 1, MAX_DUMP_COLUMNS);
+    }
+    if (params.dump) {
+        params.upper_case = seen_options.count("-u") > 0;
+    }
+
+    // The default line width of a word format holds as many digits as for single bytes
+    if (params.word_size > 1 && !seen_options.count("-c")) {
+        params.max_columns = std::max(1, params.max_columns / params.word_size);
+    }
+
+    // The other codecs write plain digits in lines of CODEC_COLUMNS characters unless -c is given
+    if (params.codec->encode_groups != nullptr) {
+        // Name the option that needs single digit pairs, a preset checks its own layout in set_language
+        std::string option;
+        if (params.dump) {
+            option = "Dumps (-lang xxd)";
+        } else if (params.word_size > 1) {
+            option = "Word presets (-lang u64)";
+        } else if (!params.prefix.empty()) {
+            option = "-prefix";
+        } else if (!params.postfix.empty()) {
+            option = "-postfix";
+        } else if (params.separator != '\0') {
+            option = "-s/-separator";
+        }
+        if (!option.empty()) {
+            print_message(*session->errors, option + " can only be used with -codec base16", params.max_chars);
+            return 1;
+        }
+        if (!seen_options.count("-c")) {
+            params.max_columns = CODEC_COLUMNS;
+        }
+        if (params.digest != DigestType::None && params.footer.empty() && !params.comment.empty()
+            && params.codec->values[static_cast<unsigned char>(params.comment[0])] != -1) {
+            print_message(*session->errors, "The digest trailer comment starts with a digit of " + std::string(params.codec->name) + ", add a -footer", params.max_chars);
+            return 1;
+        }
+    }
+
+    // Every record is converted on its own. Unless -c is given a record is one line that is never wrapped,
+    // separators and postfixes are still written between its bytes.
+    if (records != RecordMode::None) {
+        if (interactive_mode || !params.stub.empty() || has_range(params) || params.digest != DigestType::None) {
+            print_message(*session->errors, "Records cannot be used with -i/-input, a stub, -offset, -length or -digest", params.max_chars);
+            return 1;
+        }
+        if (!seen_options.count("-c") && !params.dump) {
+            params.max_columns = INT_MAX;
+        }
+        std::string layout = params.header + params.footer + params.prefix + params.postfix + params.line_start + params.line_end;
+        if (records == RecordMode::Lines && params.encode_mode && ((seen_options.count("-c") && params.max_columns > 0) || params.dump || layout.find('\n') != std::string::npos)) {
+            print_message(*session->errors, "Records of -records lines must be encoded on a single line: use -c 0 and a layout without line breaks", params.max_chars);
+            return 1;
+        }
+    }
+
+    // Resources are C arrays written to the output directory with an index header
+    if (!resource_index.empty()) {
+        if (!params.encode_mode || params.file_extension != ".c" || params.codec->encode_groups != nullptr) {
+            print_message(*session->errors, "Resources are compiled to C arrays: use -lang c, cstr, u64 or embed with base16", params.max_chars);
+            return 1;
+        }
+        if (output_dir.empty() || input_files.empty() || seen_options.count("-t") || interactive_mode || records != RecordMode::None || has_range(params)) {
+            print_message(*session->errors, "Resources are compiled from input files into the -od/-outdir directory, -offset, -length and -records cannot be used", params.max_chars);
+            return 1;
+        }
+    }
+
+    // Presets with a stub reference an input file instead of encoding its bytes, relative to the output file
+    if (!params.stub.empty()) {
+        if (!output_dir.empty()) {
+            params.stub_directory = output_dir;
+        } else if (!output_file_name.empty()) {
+            params.stub_directory = std::filesystem::path(output_file_name).parent_path().string();
+            if (params.stub_directory.empty()) {
+                params.stub_directory = ".";
+            }
+        }
+        if (!params.encode_mode) {
+            print_message(*session->errors, "Files referenced by a stub cannot be decoded", params.max_chars);
+            return 1;
+        }
+        if (seen_options.count("-t") || interactive_mode || input_files.empty()) {
+            print_message(*session->errors, "Missing input file for a stub", params.max_chars);
+            return 1;
+        }
+        if (has_range(params)) {
+            print_message(*session->errors, "A stub always references the whole file, -offset and -length cannot be used", params.max_chars);
+            return 1;
+        }
+        if (params.digest != DigestType::None) {
+            print_message(*session->errors, "A stub does not read the file, -digest cannot be used", params.max_chars);
+            return 1;
+        }
+    }
+
+    // The digest trailer is a comment line after the footer
+    if (params.digest != DigestType::None && params.comment.empty()) {
+        print_message(*session->errors, "The output has no comment syntax for a digest trailer", params.max_chars);
+        return 1;
+    }
+
+    // Under a memory limit the input is converted block by block on one thread. A quarter of the limit
+    // is the output buffer, the blocks are as large as the buffers of their conversion fit into the rest.
+    size_t output_buffer_size = OUTPUT_BUFFER_SIZE;
+    if (memory_limit > 0) {
+        if (records != RecordMode::None || !resource_index.empty() || interactive_mode || params.threads > 1) {
+            print_message(*session->errors, "A memory limit cannot be used with -records, -resources, -i/-input or -j", params.max_chars);
+            return 1;
+        }
+        if (params.encode_mode && params.header.find(SIZE_FIELD) != std::string::npos && input_files.empty() && !seen_options.count("-t")) {
+            print_message(*session->errors, "The {size} field of the header needs the whole standard input in memory, -mem cannot be used", params.max_chars);
+            return 1;
+        }
+        output_buffer_size = static_cast<size_t>(std::min<unsigned long long>(memory_limit / 4, OUTPUT_BUFFER_SIZE));
+        params.block_size = limited_block_size(static_cast<size_t>(std::min<unsigned long long>(memory_limit - output_buffer_size, SIZE_MAX)), params);
+        if (params.block_size == 0) {
+            print_message(*session->errors, "The memory limit of -mem is too small for the buffers of this output layout", params.max_chars);
+            return 1;
+        }
+        input_mode = InputMode::Stream;
+    }
+
+    // Output is collected in a large buffer, a terminal gets every line as soon as it is complete
+#ifdef _WIN32
+    int output_fd = _fileno(stdout);
+#else
+    int output_fd = context.connection != nullptr ? -1 : STDOUT_FILENO; // A client gets the output through its connection
+#endif
+    if (!output_file_name.empty()) {
+        output_fd = open_output_file(output_file_name);
+        if (output_fd < 0) {
+            print_message(*session->errors, "Failed to open output file: " + output_file_name, params.max_chars);
+            return 1;
+        }
+    }
+    if (!seen_options.count("-flush") && is_terminal(output_fd)) {
+        flush_policy = FlushPolicy::Line;
+    }
+    output_buffer = std::make_unique<OutputBuffer>(output_fd, !output_file_name.empty(), flush_policy, output_file_name.empty() ? context.connection : nullptr, output_buffer_size);
+    output = std::make_unique<std::ostream>(output_buffer.get());
+
+    // Input files are ignored when a text is typed or interactive mode is enabled
+    std::vector<std::string> files;
+    if (!seen_options.count("-t") && !interactive_mode && !expand_input_files(input_files, files, params)) {
+        return 1;
+    }
+    bool single_file = files.size() == 1 && output_dir.empty();
+    if (!files.empty() && !single_file && !seen_options.count("-j") && memory_limit == 0) {
+        params.threads = std::max(1u, std::thread::hardware_concurrency()); // Files are converted on all cores by default
+    }
+
+    // Counters are only collected when they are reported
+    session->statistics.enabled = stats_format != StatsFormat::None || progress_interval > 0;
+    std::unique_ptr<ProgressReporter> progress;
+    if (progress_interval > 0) {
+        progress = std::make_unique<ProgressReporter>(progress_interval);
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    Status status = Status::Ok;
+    bool success = true;
     try {
-        if (interactive_mode) {
-            std::stringstream buffer;
-            std::string line;
-            while (std::getline(std::cin, line)) {
-                buffer << line << std::endl;
-            }
-            std::istringstream input_stream(buffer.str());
-            handle_input(input_stream, *output, params);
-            
+        if (!resource_index.empty()) {
+            success = handle_resources(files, output_dir, resource_index, input_mode, seen_options.count("-flush") ? flush_policy : FlushPolicy::Block, params);
+        } else if (single_file) {
+            success = convert_file(files[0], *output, input_mode, records, params);
+        } else if (!files.empty()) {
+            success = handle_files(files, *output, output_dir, input_mode, records, seen_options.count("-flush") ? flush_policy : FlushPolicy::Block, output_buffer_size, params);
+        } else if (interactive_mode) {
+            status = handle_stream(true, *output, params);
+        } else if (records != RecordMode::None && input != nullptr) {
+            status = handle_records(*input, *output, records, params);
+        } else if (input == &std::cin && params.threads == 1) {
+            // Piped standard input is converted as it arrives
+            status = handle_stream(false, *output, params);
         } else { if (input == nullptr){
 		        print_help(argv[0], params.max_chars);
 		        return 0;		
 			}
-            handle_input(*input, *output, params);
+            status = has_range(params) ? handle_range(*input, *output, params) : handle_input(*input, *output, params);
         }
     } catch (const std::exception& e) {
-        print_message(std::cerr, "Error: " + std::string(e.what()), params.max_chars);
+        print_message(*session->errors, "Error: " + std::string(e.what()), params.max_chars);
         return 1;
     }
 
-    if (input != &std::cin) {
-        delete input;
+    if (!output_buffer->finish()) {
+        print_message(*session->errors, "Failed to write output", params.max_chars);
+        success = false;
     }
-    if (output != &std::cout) {
-        delete output;
+
+    progress.reset();
+    if (stats_format != StatsFormat::None) {
+        print_statistics(stats_format, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), params);
     }
 
-    return 0;
+    return success && status == Status::Ok ? 0 : 1;
+}
+
+#ifndef _WIN32
+// Stream buffer sending every write to a client as a frame of its own, safe to use from several threads
+class FrameStream : public std::streambuf {
+public:
+    FrameStream(Connection& connection, char type) : connection(connection), type(type) {}
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (traits_type::eq_int_type(ch, traits_type::eof())) {
+            return traits_type::not_eof(ch);
+        }
+        char data = traits_type::to_char_type(ch);
+        return connection.send(type, &data, 1) ? ch : traits_type::eof();
+    }
+
+    std::streamsize xsputn(const char* data, std::streamsize size) override {
+        return connection.send(type, data, size) ? size : 0;
+    }
+
+private:
+    Connection& connection;
+    char type;
+};
+
+// Stream buffer holding the standard input of a client. The input is requested when the command first reads
+// or measures it and is kept whole, so it can be measured and searched for a digest trailer like a file.
+class ClientInput : public std::streambuf {
+public:
+    explicit ClientInput(Connection& connection) : connection(connection) {}
+
+protected:
+    int_type underflow() override {
+        fetch();
+        return gptr() < egptr() ? traits_type::to_int_type(*gptr()) : traits_type::eof();
+    }
+
+    pos_type seekoff(off_type offset, std::ios::seekdir direction, std::ios::openmode) override {
+        fetch();
+        off_type base = direction == std::ios::beg ? 0 : direction == std::ios::cur ? gptr() - eback() : egptr() - eback();
+        if (base + offset < 0 || base + offset > egptr() - eback()) {
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), eback() + base + offset, egptr());
+        return pos_type(base + offset);
+    }
+
+    pos_type seekpos(pos_type position, std::ios::openmode mode) override {
+        return seekoff(off_type(position), std::ios::beg, mode);
+    }
+
+private:
+    // Function to receive the whole input from the client, a lost connection ends it
+    void fetch() {
+        if (fetched) {
+            return;
+        }
+        fetched = true;
+        std::vector<char> frame;
+        char type;
+        if (connection.send(FRAME_INPUT, "", 0)) {
+            while (connection.receive(type, frame) && type == FRAME_INPUT && !frame.empty()) {
+                StageTimer timer(Stage::Read, frame.size());
+                data.insert(data.end(), frame.begin(), frame.end());
+            }
+        }
+        setg(data.data(), data.data(), data.data() + data.size());
+    }
+
+    Connection& connection;
+    std::vector<char> data;
+    bool fetched = false;
+};
+
+// Function to serve one request: receive the command line, run it in a session of its own and send back
+// the output, the messages and the exit code. Relative paths are resolved in the directory of the client.
+void serve_client(int fd) {
+    Connection connection(fd);
+    std::vector<std::string> arguments;
+    std::string directory;
+    CommandContext context;
+    bool has_input = false;
+
+    std::vector<char> frame;
+    char type;
+    do {
+        if (!connection.receive(type, frame)) {
+            return;
+        }
+        std::string payload(frame.begin(), frame.end());
+        if (type == FRAME_ARGUMENT) {
+            arguments.push_back(payload);
+        } else if (type == FRAME_DIRECTORY) {
+            directory = payload;
+        } else if (type == FRAME_WIDTH) {
+            context.width = std::clamp(atoi(payload.c_str()), 1, INT_MAX);
+        } else if (type == FRAME_RUN) {
+            has_input = payload == "1";
+        } else {
+            return;
+        }
+    } while (type != FRAME_RUN);
+    if (arguments.empty()) {
+        return;
+    }
+
+    FrameStream output_frames(connection, FRAME_OUTPUT);
+    FrameStream error_frames(connection, FRAME_ERRORS);
+    std::ostream console(&output_frames);
+    std::ostream errors(&error_frames);
+    Session request;
+    request.console = &console;
+    request.errors = &errors;
+    request.directory = directory;
+    session = &request;
+
+    ClientInput client_input(connection);
+    std::istream input(&client_input);
+    context.input = has_input ? &input : nullptr;
+    context.connection = &connection;
+
+    std::vector<char*> argv;
+    for (std::string& argument : arguments) {
+        argv.push_back(argument.data());
+    }
+    argv.push_back(nullptr);
+
+    int exit_code;
+    try {
+        exit_code = run_command(static_cast<int>(arguments.size()), argv.data(), context);
+    } catch (const std::exception& e) {
+        print_message(errors, "Error: " + std::string(e.what()), context.width);
+        exit_code = 1;
+    }
+    connection.send(FRAME_EXIT, std::to_string(exit_code));
+    session = &process_session;
+}
+
+char server_socket_path[sizeof(sockaddr_un::sun_path)]; // Socket removed when the server is stopped
+
+// Signal handler stopping the server
+void server_signal_handler(int signum) {
+    unlink(server_socket_path);
+    _exit(0);
+}
+
+// Function to fill the address of a Unix socket, returns false when the path is too long
+bool socket_address(const std::string& path, sockaddr_un& address) {
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+#endif
+
+// Function to run the server: base16 -serve socket [-j threads]. Requests are accepted on the Unix socket
+// and run on a pool of threads until the server is stopped with a signal.
+int run_server(int argc, char* argv[]) {
+    int max_chars = get_output_width();
+#ifdef _WIN32
+    print_message(*session->errors, "The server is not available on Windows", max_chars);
+    return 1;
+#else
+    if (argc < 3) {
+        print_message(*session->errors, "Missing socket path after -serve option", max_chars);
+        return 1;
+    }
+    std::string path = argv[2];
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            try {
+                threads = std::stoi(argv[++i]);
+            } catch (const std::invalid_argument&) {
+                print_message(*session->errors, "Invalid argument for -j: " + std::string(argv[i]), max_chars);
+                return 1;
+            } catch (const std::out_of_range&) {
+                print_message(*session->errors, "Argument for -j out of range: " + std::string(argv[i]), max_chars);
+                return 1;
+            }
+            if (threads < 0) {
+                print_message(*session->errors, "Invalid argument for -j: " + std::string(argv[i]), max_chars);
+                return 1;
+            }
+            if (threads == 0) {
+                threads = std::max(1u, std::thread::hardware_concurrency());
+            }
+        } else if (arg == "-j") {
+            print_message(*session->errors, "Missing number of threads after -j option", max_chars);
+            return 1;
+        } else {
+            print_message(*session->errors, "Invalid argument: " + arg, max_chars);
+            return 1;
+        }
+    }
+
+    sockaddr_un address;
+    if (!socket_address(path, address)) {
+        print_message(*session->errors, "Invalid socket path: " + path, max_chars);
+        return 1;
+    }
+    int server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server_fd < 0) {
+        print_message(*session->errors, "Failed to create socket: " + path, max_chars);
+        return 1;
+    }
+
+    // A socket left behind by a stopped server is replaced, a running server is not
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+        if (connect(server_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            print_message(*session->errors, "A server is already running on socket: " + path, max_chars);
+            close(server_fd);
+            return 1;
+        }
+        unlink(path.c_str());
+        close(server_fd);
+        server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    }
+
+    // Only the user running the server can connect, requests read and write files with its rights
+    mode_t mask = umask(0077);
+    bool bound = bind(server_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    umask(mask);
+    if (!bound || listen(server_fd, SOMAXCONN) != 0) {
+        print_message(*session->errors, "Failed to listen on socket: " + path, max_chars);
+        close(server_fd);
+        return 1;
+    }
+    memcpy(server_socket_path, address.sun_path, sizeof(server_socket_path));
+    signal(SIGINT, server_signal_handler);
+    signal(SIGTERM, server_signal_handler);
+    signal(SIGPIPE, SIG_IGN); // A client that is gone fails the writes of its request
+
+    WorkerPool pool(threads);
+    while (true) {
+        int client_fd = accept(server_fd, nullptr, nullptr);
+        if (client_fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED || errno == EMFILE || errno == ENFILE) {
+                continue;
+            }
+            print_message(*session->errors, "Failed to accept a connection on socket: " + path, max_chars);
+            break;
+        }
+        pool.submit([client_fd] { serve_client(client_fd); });
+    }
+    close(server_fd);
+    unlink(path.c_str());
+    return 1;
+#endif
+}
+
+// Function to run a command on the server: base16 -client socket [options]. The options, the working directory,
+// the console width and, when the server asks for it, the standard input are sent; output and messages are printed.
+int run_client(int argc, char* argv[]) {
+    int max_chars = get_output_width();
+#ifdef _WIN32
+    print_message(*session->errors, "The server is not available on Windows", max_chars);
+    return 1;
+#else
+    if (argc < 3) {
+        print_message(*session->errors, "Missing socket path after -client option", max_chars);
+        return 1;
+    }
+    std::string path = argv[2];
+    sockaddr_un address;
+    if (!socket_address(path, address)) {
+        print_message(*session->errors, "Invalid socket path: " + path, max_chars);
+        return 1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        print_message(*session->errors, "Failed to connect to the server on socket: " + path, max_chars);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return 1;
+    }
+    Connection connection(fd);
+    signal(SIGPIPE, SIG_IGN);
+
+    std::error_code error;
+    bool sent = connection.send(FRAME_ARGUMENT, argv[0], strlen(argv[0]));
+    for (int i = 3; i < argc; ++i) {
+        sent = sent && connection.send(FRAME_ARGUMENT, argv[i], strlen(argv[i]));
+    }
+    sent = sent && connection.send(FRAME_DIRECTORY, std::filesystem::current_path(error).string())
+        && connection.send(FRAME_WIDTH, std::to_string(max_chars))
+        && connection.send(FRAME_RUN, is_stdin_redirected() ? "1" : "0");
+
+    // Function to write a frame to the standard output or error
+    auto write_all = [](int target, const std::vector<char>& data) {
+        for (size_t offset = 0; offset < data.size();) {
+            ssize_t length = write(target, data.data() + offset, data.size() - offset);
+            if (length < 0 && errno == EINTR) {
+                continue;
+            }
+            if (length <= 0) {
+                return false;
+            }
+            offset += length;
+        }
+        return true;
+    };
+
+    std::vector<char> frame;
+    char type;
+    while (sent && connection.receive(type, frame)) {
+        if (type == FRAME_OUTPUT) {
+            if (!write_all(STDOUT_FILENO, frame)) {
+                return 1;
+            }
+        } else if (type == FRAME_ERRORS) {
+            write_all(STDERR_FILENO, frame);
+        } else if (type == FRAME_INPUT) {
+            std::vector<char> buffer(MAX_FRAME_SIZE);
+            ssize_t length;
+            while ((length = read(STDIN_FILENO, buffer.data(), buffer.size())) != 0) {
+                if (length < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (length < 0 || !connection.send(FRAME_INPUT, buffer.data(), length)) {
+                    break;
+                }
+            }
+            connection.send(FRAME_INPUT, "", 0);
+        } else if (type == FRAME_EXIT) {
+            return atoi(std::string(frame.begin(), frame.end()).c_str());
+        }
+    }
+    print_message(*session->errors, "Lost the connection to the server on socket: " + path, max_chars);
+    return 1;
+#endif
+}
+
+int main(int argc, char* argv[]) {
+    // The server and its client are started before anything of a conversion is set up
+    std::string mode = argc > 1 ? argv[1] : "";
+    std::transform(mode.begin(), mode.end(), mode.begin(), ::tolower);
+    if (mode == "-serve") {
+        return run_server(argc, argv);
+    }
+    if (mode == "-client") {
+        return run_client(argc, argv);
+    }
+
+    CommandContext context;
+    context.input = is_stdin_redirected() ? &std::cin : nullptr;
+    context.width = get_output_width();
+    return run_command(argc, argv, context);
 }
@@ -0,0 +1,34 @@
+# Test of -offset and -length: a range of the bytes is encoded or decoded, also when it starts past the end of the
+# input or the input is empty.
+
+include("${CMAKE_CURRENT_LIST_DIR}/common.cmake")
+
+string(REPEAT "0123456789abcdefghijklmnopqrstuvwxyz\n" 100 data)
+file(WRITE "${WORK_DIR}/input.bin" "${data}")
+file(WRITE "${WORK_DIR}/empty.bin" "")
+string(SUBSTRING "${data}" 1000 500 range)
+file(WRITE "${WORK_DIR}/range.bin" "${range}")
+
+# The range of the decoded text, found by seeking and by the pipeline, is the range of the bytes
+run_base16(-f input.bin -o input.txt)
+foreach(threads 1 2)
+    run_base16(-d -j ${threads} -offset 1000 -length 500 -f input.txt -o decoded.bin)
+    expect_same_file(range.bin decoded.bin)
+    run_base16(-offset 1000 -length 500 -j ${threads} -f input.bin -o range.txt)
+    run_base16(-d -f range.txt -o decoded.bin)
+    expect_same_file(range.bin decoded.bin)
+endforeach()
+
+# A range past the end of the input or of an empty input is empty
+foreach(input input.txt empty.bin)
+    foreach(mode "-d" "-e")
+        foreach(threads 1 2)
+            run_base16(${mode} -j ${threads} -offset 100000 -length 100 -f ${input} -o out.bin)
+            if(mode STREQUAL "-d")
+                expect_same_file(empty.bin out.bin)
+            endif()
+        endforeach()
+    endforeach()
+endforeach()
+run_base16(-d -offset 10 -length 100 -f empty.bin -o out.bin)
+expect_same_file(empty.bin out.bin)
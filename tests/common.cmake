@@ -0,0 +1,24 @@
+# Setup and functions shared by the test scripts, which run with -DBASE16=<program> -DWORK_DIR=<directory>.
+# Every script starts in an empty working directory.
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}")
+
+# Function to run the program in the working directory and fail the test on a non-zero exit code.
+# The standard error of the program is returned in base16_errors.
+function(run_base16)
+    execute_process(COMMAND "${BASE16}" ${ARGN} RESULT_VARIABLE result ERROR_VARIABLE errors WORKING_DIRECTORY "${WORK_DIR}")
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "base16 ${ARGN} failed (${result}): ${errors}")
+    endif()
+    set(base16_errors "${errors}" PARENT_SCOPE)
+endfunction()
+
+# Function to fail the test unless two files of the working directory are identical
+function(expect_same_file first second)
+    file(SHA256 "${WORK_DIR}/${first}" first_hash)
+    file(SHA256 "${WORK_DIR}/${second}" second_hash)
+    if(NOT first_hash STREQUAL second_hash)
+        message(FATAL_ERROR "${first} differs from ${second}")
+    endif()
+endfunction()
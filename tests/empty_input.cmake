@@ -0,0 +1,34 @@
+# Test of the C presets with an empty input: arrays hold a single zero with a size of 0 instead of no
+# elements, which C does not allow, and decode back to no bytes.
+
+include("${CMAKE_CURRENT_LIST_DIR}/common.cmake")
+
+file(WRITE "${WORK_DIR}/empty.bin" "")
+
+# Function to encode the empty input with a preset and check the text against a pattern
+function(expect_text lang pattern)
+    run_base16(-lang ${lang} -f empty.bin -o ${lang}.c)
+    file(READ "${WORK_DIR}/${lang}.c" text)
+    if(NOT text MATCHES "${pattern}")
+        message(FATAL_ERROR "Unexpected -lang ${lang} output for an empty input:\n${text}")
+    endif()
+    if(text MATCHES "\\{[ \r\n]*\\}" OR text MATCHES "\\[0\\]")
+        message(FATAL_ERROR "-lang ${lang} declares an empty array:\n${text}")
+    endif()
+endfunction()
+
+expect_text(c "data\\[\\] = \\{\r?\n0\r?\n\\};")
+expect_text(u64 "data\\[\\] = \\{\r?\n0\r?\n\\};\r?\nconst size_t data_size = 0;")
+expect_text(cstr "data\\[0 \\+ 1\\] = \"\"")
+expect_text(embed "data\\[\\] = \\{\r?\n#embed \"empty.bin\" if_empty\\(0\\)\r?\n\\};\r?\nconst size_t data_size = 0;")
+
+# The texts decode to no bytes, with the preset given and detected
+foreach(lang c u64 cstr)
+    foreach(layout "-lang;${lang}" "")
+        run_base16(-d ${layout} -f ${lang}.c -o decoded.bin)
+        file(SIZE "${WORK_DIR}/decoded.bin" size)
+        if(NOT size EQUAL 0)
+            message(FATAL_ERROR "-lang ${lang} output of an empty input decodes to ${size} bytes with '${layout}'")
+        endif()
+    endforeach()
+endforeach()
@@ -0,0 +1,17 @@
+# Test of -i stopped with Ctrl+C: the lines read before the signal are encoded up to their last byte,
+# which the encoder holds back until the input ends, so the output is the same as at the end of the input.
+
+include("${CMAKE_CURRENT_LIST_DIR}/common.cmake")
+
+# The input stays open through a FIFO, so only the signal ends it
+execute_process(
+    COMMAND sh -c "printf 'hello\\n' | \"$0\" -i > expected.txt && mkfifo input.fifo && { \"$0\" -i < input.fifo > output.txt & pid=$!; exec 3> input.fifo; printf 'hello\\n' >&3; sleep 1; kill -INT $pid; wait $pid; }" "${BASE16}"
+    RESULT_VARIABLE result ERROR_VARIABLE errors WORKING_DIRECTORY "${WORK_DIR}")
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "base16 -i failed after Ctrl+C (${result}): ${errors}")
+endif()
+file(READ "${WORK_DIR}/output.txt" output)
+if(NOT output MATCHES "^68656C6C6F0A\n")
+    message(FATAL_ERROR "-i lost bytes after Ctrl+C: '${output}'")
+endif()
+expect_same_file(expected.txt output.txt)
@@ -0,0 +1,31 @@
+# Test of -j N -o: the output file is mapped and written at computed offsets, reported by -stats,
+# and holds the same text as the output of a single thread.
+
+include("${CMAKE_CURRENT_LIST_DIR}/common.cmake")
+
+# Several chunks of input, the last one partial
+string(REPEAT "The quick brown fox jumps over the lazy dog 0123456789abcdefghij\n" 40000 data)
+file(WRITE "${WORK_DIR}/input.bin" "${data}tail")
+
+foreach(layout "" "-lang;c" "-lang;xxd" "-codec;base64" "-digest;crc32c")
+    run_base16(${layout} -f input.bin -o serial.txt)
+    run_base16(-j 2 -stats text ${layout} -f input.bin -o mapped.txt)
+    if(NOT base16_errors MATCHES "output: mapped")
+        message(FATAL_ERROR "Encoding with ${layout} did not map the output file: ${base16_errors}")
+    endif()
+    expect_same_file(serial.txt mapped.txt)
+
+    run_base16(-d -j 2 -stats text ${layout} -f mapped.txt -o decoded.bin)
+    if(NOT base16_errors MATCHES "output: mapped")
+        message(FATAL_ERROR "Decoding with ${layout} did not map the output file: ${base16_errors}")
+    endif()
+    expect_same_file(input.bin decoded.bin)
+endforeach()
+
+# Lines holding more bytes than the first one do not fit into the computed parts and are decoded in order
+string(REPEAT " " 1000 spaces)
+string(REPEAT "0123456789abcdef" 100000 digits)
+file(WRITE "${WORK_DIR}/uneven.txt" "00${spaces}\n${digits}\n")
+run_base16(-d -f uneven.txt -o serial.bin)
+run_base16(-d -j 2 -f uneven.txt -o mapped.bin)
+expect_same_file(serial.bin mapped.bin)
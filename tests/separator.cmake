@@ -0,0 +1,25 @@
+# Test of decoding with -s: the separator is skipped between the bytes, also when it is a hexadecimal digit,
+# in short texts and in texts long enough for the vector kernels.
+
+include("${CMAKE_CURRENT_LIST_DIR}/common.cmake")
+
+# Function to decode a text with a separator and compare the bytes with the expected text
+function(expect_decoded text separator expected)
+    file(WRITE "${WORK_DIR}/input.txt" "${text}")
+    file(WRITE "${WORK_DIR}/expected.bin" "${expected}")
+    run_base16(-d -s ${separator} -f input.txt -o decoded.bin)
+    expect_same_file(expected.bin decoded.bin)
+endfunction()
+
+expect_decoded("4A1A42" "A" "AB")
+expect_decoded("41,42,43" "," "ABC")
+string(REPEAT "4A1A42A" 100 digits)
+string(REPEAT "AB" 100 bytes)
+expect_decoded("${digits}" "A" "${bytes}")
+
+# Text encoded with a separator that is no digit decodes back to the input
+string(REPEAT "The quick brown fox jumps over the lazy dog\n" 100 data)
+file(WRITE "${WORK_DIR}/data.bin" "${data}")
+run_base16(-s "|" -f data.bin -o data.txt)
+run_base16(-d -s "|" -f data.txt -o decoded.bin)
+expect_same_file(data.bin decoded.bin)